@@ -18,6 +18,8 @@
 
 #include "EEG.h"
 #include "Sound_and_Spectrum.h"
+#include "MelderThread.h"
+#include "NUM2.h"
 
 #include "oo_DESTROY.h"
 #include "EEG_def.h"
@@ -421,26 +423,106 @@ void EEG_detrend (EEG me) {
 		detrend (my sound -> z.row (ichan));
 }
 
+Thing_define (EEG_filter_Args, Thing) { public:
+	EEG eeg;
+	integer firstChannel, lastChannel;
+	NUMfft_Table fourierTable;   // shared by all threads, and only read
+	VEC data, scratch;   // this thread's own FFT buffer and FFT scratch space
+	Spectrum spectrum;   // this thread's own spectrum
+	double lowFrequency, lowWidth, highFrequency, highWidth;
+	bool doNotch50Hz;
+};
+
+Thing_implement (EEG_filter_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE EEG_filter_channels (EEG_filter_Args me) {
+	/*
+		Does for each channel what Sound_to_Spectrum (fast), Spectrum_passHannBand
+		and Spectrum_to_Sound would do, but in place, without allocating anything.
+		The number of FFT samples is a power of 2, hence even.
+	*/
+	const Sound sound = my eeg -> sound.get();
+	const integer numberOfSamples = my data.size, numberOfFrequencies = numberOfSamples / 2 + 1;
+	VEC re = my spectrum -> z.row (1), im = my spectrum -> z.row (2);
+	const double timeScaling = sound -> dx, frequencyScaling = my spectrum -> dx;
+	for (integer ichan = my firstChannel; ichan <= my lastChannel; ichan ++) {
+		my data.part (1, sound -> nx)  <<=  sound -> z.row (ichan);
+		my data.part (sound -> nx + 1, numberOfSamples)  <<=  0.0;
+		NUMfft_forward (my fourierTable, my data, my scratch);
+		re [1] = my data [1] * timeScaling;
+		im [1] = 0.0;
+		for (integer i = 2; i < numberOfFrequencies; i ++) {
+			re [i] = my data [i + i - 2] * timeScaling;
+			im [i] = my data [i + i - 1] * timeScaling;
+		}
+		re [numberOfFrequencies] = my data [numberOfSamples] * timeScaling;
+		im [numberOfFrequencies] = 0.0;
+		Spectrum_passHannBand (my spectrum, my lowFrequency, 0.0, my lowWidth);
+		Spectrum_passHannBand (my spectrum, 0.0, my highFrequency, my highWidth);
+		if (my doNotch50Hz)
+			Spectrum_stopHannBand (my spectrum, 48.0, 52.0, 1.0);
+		my data [1] = re [1] * frequencyScaling;
+		for (integer i = 2; i < numberOfFrequencies; i ++) {
+			my data [i + i - 2] = re [i] * frequencyScaling;
+			my data [i + i - 1] = im [i] * frequencyScaling;
+		}
+		my data [numberOfSamples] = re [numberOfFrequencies] * frequencyScaling;
+		NUMfft_backward (my fourierTable, my data, my scratch);
+		sound -> z.row (ichan)  <<=  my data.part (1, sound -> nx);
+	}
+	MelderThread_RETURN;
+}
+
 void EEG_filter (EEG me, double lowFrequency, double lowWidth, double highFrequency, double highWidth, bool doNotch50Hz) {
 	try {
-/*
-	integer nsampFFT = 1;
-	while (nsampFFT < my sound -> nx)
-		nsampFFT *= 2;
-	autoNUMfft_Table fftTable;
-	NUMfft_Table_init (& fftTable, nsampFFT);
-*/
-		for (integer ichan = 1; ichan <= my numberOfChannels - EEG_getNumberOfExtraSensors (me); ichan ++) {
-			autoSound channel = Sound_extractChannel (my sound.get(), ichan);
-			autoSpectrum spec = Sound_to_Spectrum (channel.get(), true);
-			Spectrum_passHannBand (spec.get(), lowFrequency, 0.0, lowWidth);
-			Spectrum_passHannBand (spec.get(), 0.0, highFrequency, highWidth);
-			if (doNotch50Hz) {
-				Spectrum_stopHannBand (spec.get(), 48.0, 52.0, 1.0);
-			}
-			autoSound him = Spectrum_to_Sound (spec.get());
-			NUMvector_copyElements (& his z [1] [0], & my sound -> z [ichan] [0], 1, my sound -> nx);
+		const integer numberOfChannels = my numberOfChannels - EEG_getNumberOfExtraSensors (me);
+		if (numberOfChannels < 1)
+			return;
+		integer numberOfFFTsamples = 2;
+		while (numberOfFFTsamples < my sound -> nx)
+			numberOfFFTsamples *= 2;
+		/*
+			The channels are independent, so they are divided over the processors.
+			The threads share one FFT table (3 n values, of which they only read the trigonometric part).
+			Every thread owns an FFT buffer, FFT scratch space and a spectrum (together about 3 n values),
+			which it reuses for all of its channels. So the temporary memory does not grow with the number of channels,
+			and the number of threads is limited so that the threads' own memory stays below 256 MB,
+			except if a single thread needs more.
+		*/
+		const double bytesPerThread = 3.0 * numberOfFFTsamples * sizeof (double);
+		const int maximumNumberOfThreadsForMemory = (int) std::max (1.0, std::min (16.0, floor (256e6 / bytesPerThread)));
+		int numberOfThreads = std::min ({ MelderThread_getNumberOfProcessors (), 16, maximumNumberOfThreadsForMemory });
+		if (numberOfThreads > numberOfChannels) numberOfThreads = numberOfChannels;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		const integer numberOfChannelsPerThread = (numberOfChannels - 1) / numberOfThreads + 1;
+		numberOfThreads = (numberOfChannels - 1) / numberOfChannelsPerThread + 1;
+
+		autoNUMfft_Table fourierTable;
+		NUMfft_Table_init (& fourierTable, numberOfFFTsamples);
+		autoVEC data [16], scratch [16];
+		autoSpectrum spectrum [16];
+		autoEEG_filter_Args args [16];
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			data [ithread - 1] = newVECraw (numberOfFFTsamples);
+			scratch [ithread - 1] = newVECraw (numberOfFFTsamples);
+			spectrum [ithread - 1] = Spectrum_create (0.5 / my sound -> dx, numberOfFFTsamples / 2 + 1);
+			spectrum [ithread - 1] -> dx = 1.0 / (my sound -> dx * numberOfFFTsamples);   // as in Sound_to_Spectrum
+			autoEEG_filter_Args arg = Thing_new (EEG_filter_Args);
+			arg -> eeg = me;
+			arg -> firstChannel = (ithread - 1) * numberOfChannelsPerThread + 1;
+			arg -> lastChannel = std::min (ithread * numberOfChannelsPerThread, numberOfChannels);
+			arg -> fourierTable = & fourierTable;
+			arg -> data = data [ithread - 1].get();
+			arg -> scratch = scratch [ithread - 1].get();
+			arg -> spectrum = spectrum [ithread - 1].get();
+			arg -> lowFrequency = lowFrequency;
+			arg -> lowWidth = lowWidth;
+			arg -> highFrequency = highFrequency;
+			arg -> highWidth = highWidth;
+			arg -> doNotch50Hz = doNotch50Hz;
+			args [ithread - 1] = arg.move();
 		}
+		MelderThread_run (EEG_filter_channels, args, numberOfThreads);
 	} catch (MelderError) {
 		Melder_throw (me, U": not filtered.");
 	}
@@ -89,12 +89,16 @@ static autoERPTier EEG_PointProcess_to_ERPTier (EEG me, PointProcess events, dou
 			double eegSample = 1 + (eegEventTime - my sound -> x1) / samplingPeriod;
 			double erpSample = 1 + (erpEventTime - firstTime) / samplingPeriod;
 			integer sampleDifference = Melder_iround (eegSample - erpSample);
-			for (integer ichannel = 1; ichannel <= thy numberOfChannels; ichannel ++) {
-				for (integer isample = 1; isample <= numberOfSamples; isample ++) {
-					integer jsample = isample + sampleDifference;
-					event -> erp -> z [ichannel] [isample] = jsample < 1 || jsample > my sound -> nx ? 0.0 : my sound -> z [ichannel] [jsample];
-				}
-			}
+			/*
+				The part of the epoch that lies within the recording is copied as one block per channel;
+				the samples before the start or after the end of the recording stay zero.
+			*/
+			const integer firstSample = std::max ((integer) 1, 1 - sampleDifference);
+			const integer lastSample = std::min (numberOfSamples, my sound -> nx - sampleDifference);
+			if (lastSample >= firstSample)
+				for (integer ichannel = 1; ichannel <= thy numberOfChannels; ichannel ++)
+					event -> erp -> z.row (ichannel).part (firstSample, lastSample)  <<=
+							my sound -> z.row (ichannel).part (firstSample + sampleDifference, lastSample + sampleDifference);
 			thy points. addItem_move (event.move());
 		}
 		return thee;
@@ -186,15 +190,11 @@ void ERPTier_subtractBaseline (ERPTier me, double tmin, double tmax) {
 		return;   // nothing to do
 	ERPPoint firstEvent = my points.at [1];
 	integer numberOfChannels = firstEvent -> erp -> ny;
-	integer numberOfSamples = firstEvent -> erp -> nx;
 	for (integer ievent = 1; ievent <= numberOfEvents; ievent ++) {
 		ERPPoint event = my points.at [ievent];
 		for (integer ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
-			double mean = Vector_getMean (event -> erp.get(), tmin, tmax, ichannel);
-			VEC channel = event -> erp -> z.row (ichannel);
-			for (integer isample = 1; isample <= numberOfSamples; isample ++) {
-				channel [isample] -= mean;
-			}
+			const double mean = Vector_getMean (event -> erp.get(), tmin, tmax, ichannel);
+			event -> erp -> z.row (ichannel)  -=  mean;
 		}
 	}
 }
@@ -208,21 +208,22 @@ void ERPTier_rejectArtefacts (ERPTier me, double threshold) {
 	integer numberOfSamples = firstEvent -> erp -> nx;
 	if (numberOfSamples < 1)
 		return;   // nothing to do
+	const integer numberOfCheckedChannels = numberOfChannels & ~ 15;
 	for (integer ievent = numberOfEvents; ievent >= 1; ievent --) {   // cycle down because of removal
 		ERPPoint event = my points.at [ievent];
-		double minimum = event -> erp -> z [1] [1];
-		double maximum = minimum;
-		for (integer ichannel = 1; ichannel <= (numberOfChannels & ~ 15); ichannel ++) {
-			constVEC channel = event -> erp -> z.row (ichannel);
-			for (integer isample = 1; isample <= numberOfSamples; isample ++) {
-				double value = channel [isample];
-				if (value < minimum) minimum = value;
-				if (value > maximum) maximum = value;
-			}
+		/*
+			An event is an artefact as soon as one of its values lies outside the threshold,
+			so the channels are scanned one at a time, and the scan stops at the first offending channel.
+			The first sample of the first channel counts even if the first channel is not checked.
+		*/
+		const double firstValue = event -> erp -> z [1] [1];
+		bool isArtefact = ( firstValue < - threshold || firstValue > threshold );
+		for (integer ichannel = 1; ichannel <= numberOfCheckedChannels && ! isArtefact; ichannel ++) {
+			const MelderRealRange extrema = NUMextrema (event -> erp -> z.row (ichannel));
+			isArtefact = ( extrema.min < - threshold || extrema.max > threshold );
 		}
-		if (minimum < - threshold || maximum > threshold) {
+		if (isArtefact)
 			my points. removeItem (ievent);
-		}
 	}
 }
 
@@ -397,6 +397,117 @@ void FFNet_computeDerivative (FFNet me) {
 	}
 }
 
+void FFNet_BatchWorkspace_init (FFNet me, FFNet_BatchWorkspace *workspace, integer maximumNumberOfRows) {
+	Melder_assert (maximumNumberOfRows > 0);
+	workspace -> activity. resize ((size_t) my numberOfLayers + 1);
+	workspace -> deriv. resize ((size_t) my numberOfLayers + 1);
+	workspace -> weightsTransposed. resize ((size_t) my numberOfLayers + 1);
+	workspace -> gradient. resize ((size_t) my numberOfLayers + 1);
+	workspace -> activity [0] = newMATraw (maximumNumberOfRows, my numberOfInputs + 1);
+	integer numberOfUnitsInPreviousLayer = my numberOfInputs, maximumNumberOfUnits = 1;
+	for (integer ilayer = 1; ilayer <= my numberOfLayers; ilayer ++) {
+		const integer numberOfUnits = my numberOfUnitsInLayer [ilayer];
+		workspace -> activity [ilayer] = newMATraw (maximumNumberOfRows, numberOfUnits + 1);
+		workspace -> deriv [ilayer] = newMATraw (maximumNumberOfRows, numberOfUnits);
+		workspace -> weightsTransposed [ilayer] = newMATraw (numberOfUnitsInPreviousLayer + 1, numberOfUnits);
+		workspace -> gradient [ilayer] = newMATraw (numberOfUnits, numberOfUnitsInPreviousLayer + 1);
+		maximumNumberOfUnits = std::max (maximumNumberOfUnits, numberOfUnits);
+		numberOfUnitsInPreviousLayer = numberOfUnits;
+	}
+	workspace -> error = newMATraw (maximumNumberOfRows, maximumNumberOfUnits);
+	workspace -> previousError = newMATraw (maximumNumberOfRows, maximumNumberOfUnits);
+}
+
+double FFNet_computeCostAndGradient_batch (FFNet me, constMATVU const& input, constMATVU const& target, VEC const& dw, FFNet_BatchWorkspace *workspace) {
+	const integer numberOfRows = input.nrow;
+	Melder_assert (input.ncol == my numberOfInputs);
+	Melder_assert (target.nrow == numberOfRows && target.ncol == my numberOfOutputs);
+	Melder_assert (dw.size == 0 || dw.size == my numberOfWeights);
+	Melder_assert (workspace -> activity.size() == (size_t) my numberOfLayers + 1);
+	Melder_assert (numberOfRows <= workspace -> activity [0]. nrow);
+	/*
+		The weights of a layer form a matrix [unit] [unitInPreviousLayer], with the bias as the last column;
+		correspondingly, the activities of a layer get a last column of ones.
+		All matrices are the top rows of the workspace, which is allocated beforehand,
+		so that nothing is allocated here, even if this runs in a thread.
+	*/
+	auto activity = [&] (integer ilayer) -> MAT { return workspace -> activity [(size_t) ilayer].horizontalBand (1, numberOfRows); };
+	auto deriv = [&] (integer ilayer) -> MAT { return workspace -> deriv [(size_t) ilayer].horizontalBand (1, numberOfRows); };
+	activity (0).verticalBand (1, my numberOfInputs) <<= input;
+	activity (0).column (my numberOfInputs + 1) <<= 1.0;
+	integer numberOfUnitsInPreviousLayer = my numberOfInputs;
+	for (integer ilayer = 1, iweight = 1; ilayer <= my numberOfLayers; ilayer ++) {
+		const integer numberOfUnits = my numberOfUnitsInLayer [ilayer];
+		const constMATVU weights (& my w [iweight], numberOfUnits, numberOfUnitsInPreviousLayer + 1, numberOfUnitsInPreviousLayer + 1, 1);
+		const MAT weightsTransposed = workspace -> weightsTransposed [(size_t) ilayer].get();   // for the fast inner loop of MATVUmul_fast
+		MATtranspose_preallocated (weightsTransposed, weights);
+		const MAT layerActivity = activity (ilayer), layerDeriv = deriv (ilayer);
+		MATVUmul_fast (layerActivity.verticalBand (1, numberOfUnits), activity (ilayer - 1), weightsTransposed);
+		const bool isLinear = ( ilayer == my numberOfLayers && my outputsAreLinear );
+		for (integer irow = 1; irow <= numberOfRows; irow ++) {
+			for (integer iunit = 1; iunit <= numberOfUnits; iunit ++) {
+				if (isLinear)
+					layerDeriv [irow] [iunit] = 1.0;
+				else
+					layerActivity [irow] [iunit] = my nonLinearity (me, layerActivity [irow] [iunit], & layerDeriv [irow] [iunit]);
+			}
+		}
+		layerActivity.column (numberOfUnits + 1) <<= 1.0;
+		iweight += numberOfUnits * (numberOfUnitsInPreviousLayer + 1);
+		numberOfUnitsInPreviousLayer = numberOfUnits;
+	}
+	/*
+		The cost and the error at the output layer, as in minimumSquaredError and minimumCrossEntropy.
+	*/
+	const MAT output = activity (my numberOfLayers), outputDeriv = deriv (my numberOfLayers);
+	MAT errorSpace = workspace -> error.get(), previousErrorSpace = workspace -> previousError.get();
+	MATVU error = errorSpace.part (1, numberOfRows, 1, my numberOfOutputs);
+	longdouble cost = 0.0;
+	for (integer irow = 1; irow <= numberOfRows; irow ++) {
+		for (integer i = 1; i <= my numberOfOutputs; i ++) {
+			const double t = target [irow] [i], o = output [irow] [i];
+			if (my costFunctionType == 2) {
+				cost -= t * log (o) + (1.0 - t) * log (1.0 - o);
+				error [irow] [i] = - (1.0 - t) / (1.0 - o) + t / o;
+			} else {
+				const double e = t - o;
+				cost += 0.5 * e * e;
+				error [irow] [i] = e;
+			}
+			error [irow] [i] *= outputDeriv [irow] [i];
+		}
+	}
+	if (dw.size == 0)
+		return (double) cost;
+	/*
+		Backpropagation: the derivatives of a layer's weights are minus the sum over the rows
+		of the outer products of its errors and the previous layer's activities.
+		The errors of the previous layer go into the other error matrix of the workspace.
+	*/
+	for (integer ilayer = my numberOfLayers, iweight = my numberOfWeights + 1; ilayer >= 1; ilayer --) {
+		const integer numberOfUnits = my numberOfUnitsInLayer [ilayer];
+		const integer numberOfUnitsInPrevious = ( ilayer == 1 ? my numberOfInputs : my numberOfUnitsInLayer [ilayer - 1] );
+		iweight -= numberOfUnits * (numberOfUnitsInPrevious + 1);
+		const MAT gradient = workspace -> gradient [(size_t) ilayer].get();
+		MATVUmul_fast (gradient, error.transpose(), activity (ilayer - 1));
+		for (integer iunit = 1, jweight = iweight; iunit <= numberOfUnits; iunit ++)
+			for (integer j = 1; j <= numberOfUnitsInPrevious + 1; j ++, jweight ++)
+				dw [jweight] -= gradient [iunit] [j];
+		if (ilayer > 1) {
+			const constMATVU weights (& my w [iweight], numberOfUnits, numberOfUnitsInPrevious + 1, numberOfUnitsInPrevious + 1, 1);
+			const MATVU previousError = previousErrorSpace.part (1, numberOfRows, 1, numberOfUnitsInPrevious);
+			MATVUmul_fast (previousError, error, weights.verticalBand (1, numberOfUnitsInPrevious));
+			const MAT previousDeriv = deriv (ilayer - 1);
+			for (integer irow = 1; irow <= numberOfRows; irow ++)
+				for (integer j = 1; j <= numberOfUnitsInPrevious; j ++)
+					previousError [irow] [j] *= previousDeriv [irow] [j];
+			std::swap (errorSpace, previousErrorSpace);
+			error = previousError;
+		}
+	}
+	return (double) cost;
+}
+
 /******* end operation ******************************************************/
 
 integer FFNet_getWinningUnit (FFNet me, int labeling) {
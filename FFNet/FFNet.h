@@ -174,6 +174,20 @@ void FFNet_computeDerivative (FFNet me);
 /* step (4) compute derivative in my dwi */
 /* Precondition: step (3) */
 
+struct FFNet_BatchWorkspace {
+	std::vector <autoMAT> activity, deriv, weightsTransposed, gradient;   // [0..numberOfLayers]
+	autoMAT error, previousError;
+};
+void FFNet_BatchWorkspace_init (FFNet me, FFNet_BatchWorkspace *workspace, integer maximumNumberOfRows);
+/* allocates the scratch matrices of FFNet_computeCostAndGradient_batch, for batches of at most maximumNumberOfRows rows */
+
+double FFNet_computeCostAndGradient_batch (FFNet me, constMATVU const& input, constMATVU const& target, VEC const& dw, FFNet_BatchWorkspace *workspace);
+/* steps (1) to (4) for all rows of input at once, with one matrix product per layer in each direction;
+ * returns the summed cost, and adds the summed derivatives (as in dwi) to dw, unless dw is empty.
+ * Leaves my activity, error and deriv alone, and allocates nothing, so that several batches
+ * can be computed at the same time, in different threads, each with its own workspace.
+ */
+
 integer FFNet_getWinningUnit (FFNet me, int labeling);
 /* labeling = 1 : winner-takes-all */
 /* labeling = 2 : stochastic */
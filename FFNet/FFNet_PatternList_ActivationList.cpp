@@ -26,24 +26,94 @@
 
 #include "Graphics.h"
 #include "FFNet_PatternList_ActivationList.h"
+#include "MelderThread.h"
+
+/*
+	The patterns are divided into at most FFNet_MAXIMUM_NUMBER_OF_CHUNKS chunks of consecutive rows,
+	which are divided over the threads. Every chunk goes through the net in batches of
+	FFNet_BATCH_SIZE rows, and sums its own costs and derivatives. The chunks are added up in order,
+	so the cost and the gradient do not depend on the number of threads.
+*/
+#define FFNet_BATCH_SIZE  256
+#define FFNet_MAXIMUM_NUMBER_OF_CHUNKS  16
+
+Thing_define (FFNet_chunks_Args, Thing) { public:
+	FFNet ffnet;
+	integer firstChunk, lastChunk, numberOfChunks;
+	MAT chunkDerivatives;   // [chunk] [weight]
+	VEC chunkCosts;
+	FFNet_BatchWorkspace workspace;   // allocated by the calling thread
+};
+
+Thing_implement (FFNet_chunks_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE FFNet_computeChunks (FFNet_chunks_Args me) {
+	FFNet ffnet = my ffnet;
+	for (integer ichunk = my firstChunk; ichunk <= my lastChunk; ichunk ++) {
+		const integer firstPattern = 1 + (ichunk - 1) * ffnet -> numberOfPatterns / my numberOfChunks;
+		const integer lastPattern = ichunk * ffnet -> numberOfPatterns / my numberOfChunks;
+		my chunkDerivatives.row (ichunk) <<= 0.0;
+		longdouble cost = 0.0;
+		for (integer first = firstPattern; first <= lastPattern; first += FFNet_BATCH_SIZE) {
+			const integer last = std::min (first + FFNet_BATCH_SIZE - 1, lastPattern);
+			cost += FFNet_computeCostAndGradient_batch (ffnet,
+				ffnet -> inputPattern.horizontalBand (first, last),
+				ffnet -> targetActivation.horizontalBand (first, last),
+				my chunkDerivatives.row (ichunk),
+				& my workspace
+			);
+		}
+		my chunkCosts [ichunk] = (double) cost;
+	}
+	MelderThread_RETURN;
+}
 
 static double func (Daata object, VEC p) {
 	FFNet me = (FFNet) object;
 	Minimizer thee = my minimizer.get();
-	longdouble fp = 0.0;
 
 	for (integer j = 1, k = 1; k <= my numberOfWeights; k ++) {
 		my dw [k] = 0.0;
 		if (my wSelected [k])
 			my w [k] = p [j ++];
 	}
-	for (integer i = 1; i <= my numberOfPatterns; i ++) {
-		FFNet_propagate (me, my inputPattern.row (i), nullptr);
-		fp += FFNet_computeError (me, my targetActivation.row (i));
-		FFNet_computeDerivative (me);
-		/* derivative (cumulative) */
-		for (integer k = 1; k <= my numberOfWeights; k ++)
-			my dw [k] += my dwi [k];
+	if (Melder_debug == 53) {   // the pattern-by-pattern reference for the batches
+		longdouble fp = 0.0;
+		for (integer i = 1; i <= my numberOfPatterns; i ++) {
+			FFNet_propagate (me, my inputPattern.row (i), nullptr);
+			fp += FFNet_computeError (me, my targetActivation.row (i));
+			FFNet_computeDerivative (me);
+			for (integer k = 1; k <= my numberOfWeights; k ++)
+				my dw [k] += my dwi [k];
+		}
+		thy funcCalls ++;
+		return (double) fp;
+	}
+	const integer numberOfChunks = std::min ((my numberOfPatterns - 1) / FFNet_BATCH_SIZE + 1, (integer) FFNet_MAXIMUM_NUMBER_OF_CHUNKS);
+	autoMAT chunkDerivatives = newMATraw (numberOfChunks, my numberOfWeights);
+	autoVEC chunkCosts = newVECraw (numberOfChunks);
+
+	int numberOfThreads = std::min ((int) numberOfChunks, MelderThread_getNumberOfProcessors ());
+	if (numberOfThreads < 1)
+		numberOfThreads = 1;
+	autoFFNet_chunks_Args args [FFNet_MAXIMUM_NUMBER_OF_CHUNKS];
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoFFNet_chunks_Args arg = Thing_new (FFNet_chunks_Args);
+		arg -> ffnet = me;
+		arg -> firstChunk = 1 + (ithread - 1) * numberOfChunks / numberOfThreads;
+		arg -> lastChunk = ithread * numberOfChunks / numberOfThreads;
+		arg -> numberOfChunks = numberOfChunks;
+		arg -> chunkDerivatives = chunkDerivatives.get();
+		arg -> chunkCosts = chunkCosts.get();
+		FFNet_BatchWorkspace_init (me, & arg -> workspace, std::min (my numberOfPatterns, (integer) FFNet_BATCH_SIZE));
+		args [ithread - 1] = arg.move();
+	}
+	MelderThread_run (FFNet_computeChunks, args, numberOfThreads);
+
+	longdouble fp = 0.0;
+	for (integer ichunk = 1; ichunk <= numberOfChunks; ichunk ++) {
+		fp += chunkCosts [ichunk];
+		my dw.all() += chunkDerivatives.row (ichunk);
 	}
 	thy funcCalls ++;
 	return (double) fp;
@@ -149,12 +219,22 @@ double FFNet_PatternList_ActivationList_getCosts_total (FFNet me, PatternList p,
 		_FFNet_PatternList_ActivationList_checkDimensions (me, p, a);
 		FFNet_setCostFunction (me, costFunctionType);
 
-		double cost = 0.0;
-		for (integer i = 1; i <= p -> ny; i ++) {
-			FFNet_propagate (me, p -> z.row (i), nullptr);
-			cost += FFNet_computeError (me, a -> z.row (i));
+		if (Melder_debug == 53) {
+			longdouble cost = 0.0;
+			for (integer i = 1; i <= p -> ny; i ++) {
+				FFNet_propagate (me, p -> z.row (i), nullptr);
+				cost += FFNet_computeError (me, a -> z.row (i));
+			}
+			return (double) cost;
+		}
+		FFNet_BatchWorkspace workspace;
+		FFNet_BatchWorkspace_init (me, & workspace, std::min (p -> ny, (integer) FFNet_BATCH_SIZE));
+		longdouble cost = 0.0;
+		for (integer first = 1; first <= p -> ny; first += FFNet_BATCH_SIZE) {
+			const integer last = std::min (first + FFNet_BATCH_SIZE - 1, p -> ny);
+			cost += FFNet_computeCostAndGradient_batch (me, p -> z.horizontalBand (first, last), a -> z.horizontalBand (first, last), VEC (), & workspace);
 		}
-		return cost;
+		return (double) cost;
 	} catch (MelderError) {
 		return undefined;
 	}
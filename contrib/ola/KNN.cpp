@@ -50,6 +50,8 @@
 
 Thing_implement (KNN, Daata, 0);
 
+Thing_implement (KNNIndex, Thing, 0);
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Praat specifics                                                                         //
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -106,6 +108,7 @@ int KNN_learn
             my input = Data_copy (p);   // LEAK
             my output = Data_copy (c);
             my nInstances = c->size;
+            my index.reset();
 
             break;
 
@@ -133,6 +136,7 @@ int KNN_learn
                 my input = tinput.move();
                 my output = toutput.move();
                 my nInstances += p -> ny;
+                my index.reset();
             } else {                                // fail
                 return kOla_DIMENSIONALITY_MISMATCH;
             }
@@ -162,6 +166,10 @@ typedef struct
         int dist;
         integer istart;
         integer istop;
+        integer * indices;      // this thread's own workspace [0..k],
+        integer * freqindices;  // allocated beforehand, because the threads should not allocate
+        double * distances;
+        double * freqs;
 
 } KNN_input_ToCategories_t;
 
@@ -184,67 +192,34 @@ autoCategories KNN_classifyToCategories
 
 {
     int nthreads = KNN_getNumberOfCPUs();
-    integer *outputindices = NUMvector <integer> (0, ps -> ny);
-    integer chunksize = ps -> ny / nthreads;
+    autoNUMvector <integer> outputindices ((integer) 0, ps -> ny);
 
     Melder_assert (nthreads > 0);
     Melder_assert (k > 0 && k <= my nInstances);
 
-    if(chunksize < 1) {
-        chunksize = 1;
-        nthreads = ps -> ny;
-    }
+    KNN_getIndex (me);   // if worthwhile; before the threads start
 
-    integer istart = 1;
-    integer istop = chunksize;
+    if (nthreads > ps -> ny)
+        nthreads = ps -> ny;
 
     autoCategories output = Categories_create ();
-    KNN_input_ToCategories_t ** input = (KNN_input_ToCategories_t **) malloc (nthreads * sizeof (KNN_input_ToCategories_t *));
-
-    if (! input)
-        return autoCategories();
-
-    for (int i = 0; i < nthreads; i ++) {
-        input [i] = (KNN_input_ToCategories_t *) malloc (sizeof (KNN_input_ToCategories_t));
-        if (! input [i]) {
-            while (input [i --])
-                free (input [i]);
-            free (input);
-            return autoCategories();
-        }
-    }
-
-    for (int i = 0; i < nthreads; i ++) {
-        input [i] -> me = me;
-        input [i] -> ps = ps;
-        input [i] -> output = outputindices;
-        input [i] -> fws = fws;
-        input [i] -> k = k;
-        input [i] -> dist = dist;
-        input [i] -> istart = istart;
-
-        if (istop + chunksize > ps -> ny) {
-            input [i] -> istop = ps -> ny;
-            break;
-        } else {
-            input [i] -> istop = istop;
-            istart = istop + 1;
-            istop += chunksize;
-        }
+    autoNUMmatrix <integer> indices (0, nthreads - 1, 0, k), freqindices (0, nthreads - 1, 0, k);
+    autoNUMmatrix <double> distances (0, nthreads - 1, 0, k), freqs (0, nthreads - 1, 0, k);
+    std::vector <KNN_input_ToCategories_t> inputs ((size_t) nthreads);
+    std::vector <void *> pointers ((size_t) nthreads);
+    for (int i = 0; i < nthreads; i ++) {   // every row is classified independently, in one of nthreads consecutive ranges
+        inputs [(size_t) i] = { me, ps, outputindices.peek(), fws, k, dist,
+            1 + i * ps -> ny / nthreads, (i + 1) * ps -> ny / nthreads,
+            indices [i], freqindices [i], distances [i], freqs [i] };
+        pointers [(size_t) i] = & inputs [(size_t) i];
     }
- 
-    enum KNN_thread_status * error = (enum KNN_thread_status *) KNN_threadDistribution(KNN_classifyToCategoriesAux, (void **) input, nthreads);
-    //void *error = KNN_classifyToCategoriesAux (input [0]);
-    for (int i = 0; i < nthreads; i ++)
-        free (input [i]);
-    free (input);
+    void *error = KNN_threadDistribution (KNN_classifyToCategoriesAux, pointers.data(), nthreads);
     if (error) {           // Something went very wrong, you ought to inform the user!
         free (error);
         return autoCategories();
     }
 	for (integer i = 1; i <= ps -> ny; i ++)
 		output -> addItem_move (Data_copy (my output->at [outputindices [i]]));
-	NUMvector_free (outputindices, 0);
     return output;
 }
 
@@ -268,11 +243,11 @@ void * KNN_classifyToCategoriesAux
     integer ncollected;
     integer ncategories;
 
-    integer *indices = NUMvector <integer> (0, ((KNN_input_ToCategories_t *) input)->k);
-    integer *freqindices = NUMvector <integer> (0, ((KNN_input_ToCategories_t *) input)->k);
+    integer *indices = ((KNN_input_ToCategories_t *) input)->indices;
+    integer *freqindices = ((KNN_input_ToCategories_t *) input)->freqindices;
 
-    double *distances = NUMvector <double> (0, ((KNN_input_ToCategories_t *) input)->k);
-    double *freqs = NUMvector <double> (0, ((KNN_input_ToCategories_t *) input)->k);
+    double *distances = ((KNN_input_ToCategories_t *) input)->distances;
+    double *freqs = ((KNN_input_ToCategories_t *) input)->freqs;
  
     for (integer y = ((KNN_input_ToCategories_t *) input)->istart; y <= ((KNN_input_ToCategories_t *) input)->istop; ++y)
     {
@@ -280,12 +255,20 @@ void * KNN_classifyToCategoriesAux
         // Localizing the k nearest neighbours //
         /////////////////////////////////////////
 
-        ncollected = KNN_kNeighbours (
-            ((KNN_input_ToCategories_t *) input)->ps, 
-            ((KNN_input_ToCategories_t *) input)->me->input.get(),
-            ((KNN_input_ToCategories_t *) input)->fws, y, 
-            ((KNN_input_ToCategories_t *) input)->k, indices, distances
-        );
+        if (((KNN_input_ToCategories_t *) input)->me->index)
+            ncollected = KNNIndex_kNeighbours (
+                ((KNN_input_ToCategories_t *) input)->me->index.get(),
+                ((KNN_input_ToCategories_t *) input)->ps, 
+                ((KNN_input_ToCategories_t *) input)->fws, y, 
+                ((KNN_input_ToCategories_t *) input)->k, indices, distances
+            );
+        else
+            ncollected = KNN_kNeighbours (
+                ((KNN_input_ToCategories_t *) input)->ps, 
+                ((KNN_input_ToCategories_t *) input)->me->input.get(),
+                ((KNN_input_ToCategories_t *) input)->fws, y, 
+                ((KNN_input_ToCategories_t *) input)->k, indices, distances
+            );
 
         /////////////////////////////////////////////////
         // Computing frequencies and average distances //
@@ -317,10 +300,6 @@ void * KNN_classifyToCategoriesAux
         ((KNN_input_ToCategories_t *) input)->output[y] = freqindices[KNN_max(freqs, ncategories)];
     }
 
-	NUMvector_free (indices, 0);
-	NUMvector_free (freqindices, 0);
-	NUMvector_free (distances, 0);
-	NUMvector_free (freqs, 0);
     return nullptr;
 }
 
@@ -338,6 +317,8 @@ typedef struct {
 	int dist;
 	integer istart;
 	integer istop;
+	integer *indices, *freqindices;   // this thread's own workspace [0..k], allocated beforehand
+	double *distances, *freqs;
 } KNN_input_ToTableOfReal_t;
 
 autoTableOfReal KNN_classifyToTableOfReal
@@ -359,7 +340,6 @@ autoTableOfReal KNN_classifyToTableOfReal
 
 {
     int nthreads = KNN_getNumberOfCPUs();
-    integer chunksize =  ps->ny / nthreads;
     autoCategories uniqueCategories = Categories_selectUniqueItems (my output.get());
     integer ncategories = uniqueCategories->size;
    
@@ -370,59 +350,27 @@ autoTableOfReal KNN_classifyToTableOfReal
     if (! ncategories)
         return autoTableOfReal();
 
-    if (chunksize < 1) {
-        chunksize = 1;
-        nthreads = ps -> ny;
-    }
-
-    integer istart = 1;
-    integer istop = chunksize;
+    KNN_getIndex (me);   // if worthwhile; before the threads start
 
-    KNN_input_ToTableOfReal_t ** input = (KNN_input_ToTableOfReal_t **) malloc (nthreads * sizeof (KNN_input_ToTableOfReal_t *));
-    
-    if (! input)
-        return autoTableOfReal();
+    if (nthreads > ps -> ny)
+        nthreads = ps -> ny;
 
     autoTableOfReal output = TableOfReal_create (ps -> ny, ncategories);
 
     for (integer i = 1; i <= ncategories; i ++)
         TableOfReal_setColumnLabel (output.get(), i, uniqueCategories->at [i] -> string.get());
 
-    for (int i = 0; i < nthreads; i ++) {
-        input [i] = (KNN_input_ToTableOfReal_t *) malloc (sizeof (KNN_input_ToTableOfReal_t));
-        if (! input [i]) {
-            while (input [i --])   // ppgb FIXME: is always false
-                free (input [i]);   // ppgb FIXME: the stopping condition is incorrect
-            free (input);
-            return autoTableOfReal();
-        }
-    }
-
-    for (int i = 0; i < nthreads; i ++) {
-        input [i] -> me = me;
-        input [i] -> ps = ps;
-        input [i] -> output = output.get();   // YUCK: reference copy
-        input [i] -> uniqueCategories = uniqueCategories.releaseToAmbiguousOwner();
-        input [i] -> fws = fws;
-        input [i] -> k = k;
-        input [i] -> dist = dist;
-        input [i] -> istart = istart;
-
-        if (istop + chunksize > ps -> ny) {
-            input [i] -> istop = ps -> ny;
-            break;
-        } else {
-            input [i] -> istop = istop;
-            istart = istop + 1;
-            istop += chunksize;
-        }
+    autoNUMmatrix <integer> indices (0, nthreads - 1, 0, k), freqindices (0, nthreads - 1, 0, k);
+    autoNUMmatrix <double> distances (0, nthreads - 1, 0, k), freqs (0, nthreads - 1, 0, k);
+    std::vector <KNN_input_ToTableOfReal_t> inputs ((size_t) nthreads);
+    std::vector <void *> pointers ((size_t) nthreads);
+    for (int i = 0; i < nthreads; i ++) {   // every thread fills its own rows
+        inputs [(size_t) i] = { me, ps, uniqueCategories.get(), output.get(), fws, k, dist,
+            1 + i * ps -> ny / nthreads, (i + 1) * ps -> ny / nthreads,
+            indices [i], freqindices [i], distances [i], freqs [i] };
+        pointers [(size_t) i] = & inputs [(size_t) i];
     }
- 
-    enum KNN_thread_status * error = (enum KNN_thread_status *) KNN_threadDistribution (KNN_classifyToTableOfRealAux, (void **) input, nthreads);
-    for (int i = 0; i < nthreads; i ++)
-        free (input [i]);
-  
-    free (input);
+    void *error = KNN_threadDistribution (KNN_classifyToTableOfRealAux, pointers.data(), nthreads);
     if (error)           // Something went very wrong, you ought to inform the user!
     {
         free (error);
@@ -445,50 +393,37 @@ void * KNN_classifyToTableOfRealAux
 {
 	KNN_input_ToTableOfReal_t *input = (KNN_input_ToTableOfReal_t *) void_input;
     integer ncategories = input -> uniqueCategories->size;
-    autoNUMvector <integer> indices ((integer) 0, input -> k);
-    autoNUMvector <double> distances ((integer) 0, input -> k);
+    integer *indices = input -> indices, *freqindices = input -> freqindices;
+    double *distances = input -> distances, *freqs = input -> freqs;
 
 	for (integer y = input -> istart; y <= input -> istop; y ++) {
-		KNN_kNeighbours (input -> ps, input -> me -> input.get(), input -> fws, y, input -> k, indices.peek(), distances.peek());
-		for (integer i = 0; i < input -> k; i ++) {
+		if (input -> me -> index)
+			KNNIndex_kNeighbours (input -> me -> index.get(), input -> ps, input -> fws, y, input -> k, indices, distances);
+		else
+			KNN_kNeighbours (input -> ps, input -> me -> input.get(), input -> fws, y, input -> k, indices, distances);
+
+		/*
+			The votes of this row, weighted by this row's own distances, as in KNN_classifyToCategoriesAux.
+		*/
+		integer nfound = KNN_kIndicesToFrequenciesAndDistances (input -> me -> output.get(), input -> k,
+				indices, distances, freqs, freqindices);
+		switch (input -> dist) {
+			case kOla_DISTANCE_WEIGHTED_VOTING:
+				for (integer c = 0; c < nfound; c ++)
+					freqs [c] *= 1.0 / OlaMAX (distances [c], kOla_MINFLOAT);
+				break;
+			case kOla_SQUARED_DISTANCE_WEIGHTED_VOTING:
+				for (integer c = 0; c < nfound; c ++)
+					freqs [c] *= 1.0 / OlaMAX (OlaSQUARE (distances [c]), kOla_MINFLOAT);
+		}
+		KNN_normalizeFloatArray (freqs, nfound);
+		for (integer c = 0; c < nfound; c ++) {
 			for (integer j = 1; j <= ncategories; j ++) {
-				if (FeatureWeights_areFriends (input -> me -> output->at [indices [i]], input -> uniqueCategories->at [j]))
-					input -> output -> data [y] [j] += 1.0;
+				if (FeatureWeights_areFriends (input -> me -> output->at [freqindices [c]], input -> uniqueCategories->at [j]))
+					input -> output -> data [y] [j] += freqs [c];
 			}
 		}
 	}
-	switch (input -> dist) {
-		case kOla_DISTANCE_WEIGHTED_VOTING:
-			for (integer y = input -> istart; y <= input -> istop; y ++) {
-				longdouble sum = 0.0;
-				for (integer c = 1; c <= ncategories; c ++) {
-					input -> output -> data [y] [c] *= 1.0 / OlaMAX (distances [c], kOla_MINFLOAT);
-					sum += input -> output -> data [y] [c];
-				}
-				for (integer c = 1; c <= ncategories; c ++)
-					input -> output -> data [y] [c] /= sum;
-			}
-			break;
-		case kOla_SQUARED_DISTANCE_WEIGHTED_VOTING:
-			for (integer y = input -> istart; y <= input -> istop; y ++) {
-				longdouble sum = 0.0;
-				for (integer c = 1; c <= ncategories; c ++) {
-					input -> output -> data [y] [c] *= 1.0 / OlaMAX (OlaSQUARE (distances [c]), kOla_MINFLOAT);
-					sum += input -> output -> data [y] [c];
-				}
-				for (integer c = 1; c <= ncategories; c ++)
-					input -> output -> data [y] [c] /= sum;
-			}
-			break;
-		case kOla_FLAT_VOTING:
-			for (integer y = input -> istart; y <= input -> istop; y ++) {
-				longdouble sum = 0.0;
-				for (integer c = 1; c <= ncategories; c ++)
-					sum += input -> output -> data [y] [c];
-				for (integer c = 1; c <= ncategories; c ++)
-					input -> output -> data [y] [c] /= sum;
-			}
-	}
 	return nullptr;
 }
 
@@ -496,26 +431,12 @@ void * KNN_classifyToTableOfRealAux
 // Classification - Folding                                                                //
 /////////////////////////////////////////////////////////////////////////////////////////////
 
-autoCategories KNN_classifyFold
+// The classification of the fold, as indices into the output of the KNN, without allocating anything,
+// so that it can run in a thread; the workspaces have to hold k + 1 elements, outputindices end - begin + 1
+static integer KNN_classifyFoldIntoIndices
 (
-    ///////////////////////////////
-    // Parameters                //
-    ///////////////////////////////
-
-    KNN me,             // the classifier being used
-                        //
-    PatternList ps,     // source PatternList
-                        //
-    FeatureWeights fws, // feature weights
-                        //
-    integer k,          // the number of sought after neighbours
-                        //
-    int dist,           // distance weighting
-                        //
-    integer begin,      // fold start, inclusive [...
-                        //
-    integer end         // fold end, inclusive ...]
-                        //
+    KNN me, PatternList ps, FeatureWeights fws, integer k, int dist, integer begin, integer end,
+    integer *indices, integer *freqindices, double *distances, double *freqs, integer *outputindices
 )
 
 {
@@ -531,11 +452,6 @@ autoCategories KNN_classifyFold
 
     integer ncollected;
     integer ncategories;
-    autoNUMvector <integer> indices ((integer) 0, k);
-    autoNUMvector <integer> freqindices ((integer) 0, k);
-    autoNUMvector <double> distances ((integer) 0, k);
-    autoNUMvector <double> freqs ((integer) 0, k);
-    autoNUMvector <integer> outputindices ((integer) 0, ps->ny);
     integer noutputindices = 0;
 
     for (integer y = begin; y <= end; y ++)
@@ -544,13 +460,13 @@ autoCategories KNN_classifyFold
         // Localizing the k nearest neighbours //
         /////////////////////////////////////////
 
-        ncollected = KNN_kNeighboursSkipRange (ps, my input.get(), fws, y, k, indices.peek(), distances.peek(), begin, end);
+        ncollected = KNN_kNeighboursSkipRange (ps, my input.get(), fws, y, k, indices, distances, begin, end);
 
         /////////////////////////////////////////////////
         // Computing frequencies and average distances //
         /////////////////////////////////////////////////
 
-        ncategories = KNN_kIndicesToFrequenciesAndDistances (my output.get(), k, indices.peek(), distances.peek(), freqs.peek(), freqindices.peek());
+        ncategories = KNN_kIndicesToFrequenciesAndDistances (my output.get(), k, indices, distances, freqs, freqindices);
 
         ////////////////////////
         // Distance weighting //
@@ -568,9 +484,42 @@ autoCategories KNN_classifyFold
                     freqs [c] *= 1.0 / OlaMAX (OlaSQUARE (distances [c]), kOla_MINFLOAT);
         }
 
-        KNN_normalizeFloatArray (freqs.peek(), ncategories);
-        outputindices [noutputindices ++] = freqindices [KNN_max (freqs.peek(), ncategories)];
+        KNN_normalizeFloatArray (freqs, ncategories);
+        outputindices [noutputindices ++] = freqindices [KNN_max (freqs, ncategories)];
     }
+    return noutputindices;
+}
+
+autoCategories KNN_classifyFold
+(
+    ///////////////////////////////
+    // Parameters                //
+    ///////////////////////////////
+
+    KNN me,             // the classifier being used
+                        //
+    PatternList ps,     // source PatternList
+                        //
+    FeatureWeights fws, // feature weights
+                        //
+    integer k,          // the number of sought after neighbours
+                        //
+    int dist,           // distance weighting
+                        //
+    integer begin,      // fold start, inclusive [...
+                        //
+    integer end         // fold end, inclusive ...]
+                        //
+)
+
+{
+    autoNUMvector <integer> indices ((integer) 0, k);
+    autoNUMvector <integer> freqindices ((integer) 0, k);
+    autoNUMvector <double> distances ((integer) 0, k);
+    autoNUMvector <double> freqs ((integer) 0, k);
+    autoNUMvector <integer> outputindices ((integer) 0, ps->ny);
+    integer noutputindices = KNN_classifyFoldIntoIndices (me, ps, fws, k, dist, begin, end,
+        indices.peek(), freqindices.peek(), distances.peek(), freqs.peek(), outputindices.peek());
 
 	autoCategories output = Categories_create ();
 	for (integer o = 0; o < noutputindices; o ++)
@@ -578,6 +527,103 @@ autoCategories KNN_classifyFold
 	return output;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Evaluation - folds in parallel                                                          //
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    integer k;
+    int dist;
+    integer begin;
+    integer end;
+    integer ncorrect;   // out
+} KNN_fold_t;
+
+typedef struct {
+    KNN me;
+    FeatureWeights fws;
+    KNN_fold_t *folds;
+    integer nfolds;
+    int ithread;
+    int nthreads;
+    integer *indices, *freqindices;   // this thread's own workspace, allocated beforehand,
+    double *distances, *freqs;        // because the threads should not allocate
+    integer *outputindices;
+} KNN_input_Folds_t;
+
+static void * KNN_evaluateFoldsAux
+(
+    void * void_input
+)
+
+{
+    KNN_input_Folds_t *input = (KNN_input_Folds_t *) void_input;
+    KNN me = input -> me;
+    for (integer i = input -> ithread; i < input -> nfolds; i += input -> nthreads) {   // interleaved, because folds with a large k take longer
+        KNN_fold_t *fold = & input -> folds [i];
+        integer noutputindices = KNN_classifyFoldIntoIndices (me, my input.get(), input -> fws, fold -> k, fold -> dist, fold -> begin, fold -> end,
+            input -> indices, input -> freqindices, input -> distances, input -> freqs, input -> outputindices);
+        fold -> ncorrect = 0;
+        for (integer o = 0; o < noutputindices; o ++)
+            if (FeatureWeights_areFriends (my output->at [input -> outputindices [o]], my output->at [fold -> begin + o]))
+                fold -> ncorrect ++;
+    }
+    return nullptr;
+}
+
+// Every fold is classified independently and counts its own correct answers,
+// so the results do not depend on the number of threads.
+static void KNN_evaluateFolds
+(
+    KNN me, FeatureWeights fws, KNN_fold_t *folds, integer nfolds
+)
+
+{
+    int nthreads = KNN_getNumberOfCPUs();
+    if (nthreads > nfolds)
+        nthreads = nfolds;
+    integer maximumK = 1, maximumFoldSize = 1;
+    for (integer i = 0; i < nfolds; i ++) {
+        maximumK = std::max (maximumK, folds [i]. k);
+        maximumFoldSize = std::max (maximumFoldSize, folds [i]. end - folds [i]. begin + 1);
+    }
+    autoNUMmatrix <integer> indices (0, nthreads - 1, 0, maximumK), freqindices (0, nthreads - 1, 0, maximumK);
+    autoNUMmatrix <double> distances (0, nthreads - 1, 0, maximumK), freqs (0, nthreads - 1, 0, maximumK);
+    autoNUMmatrix <integer> outputindices (0, nthreads - 1, 0, maximumFoldSize - 1);
+    std::vector <KNN_input_Folds_t> inputs ((size_t) nthreads);
+    std::vector <void *> pointers ((size_t) nthreads);
+    for (int i = 0; i < nthreads; i ++) {
+        inputs [(size_t) i] = { me, fws, folds, nfolds, i, nthreads,
+            indices [i], freqindices [i], distances [i], freqs [i], outputindices [i] };
+        pointers [(size_t) i] = & inputs [(size_t) i];
+    }
+    void *error = KNN_threadDistribution (KNN_evaluateFoldsAux, pointers.data(), nthreads);
+    if (error) {
+        free (error);
+        Melder_throw (U"Evaluation not performed.");
+    }
+}
+
+// The size of a fold (the last one may be smaller); 0 if the evaluation mode cannot be used.
+static integer KNN_foldSize
+(
+    KNN me, int mode
+)
+
+{
+    switch (mode)
+    {
+        case kOla_TEN_FOLD_CROSS_VALIDATION:
+            return my nInstances / 10;
+
+        case kOla_LEAVE_ONE_OUT:
+            return my nInstances > 1 ? 1 : 0;
+
+        default:
+            return 0;
+    }
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Evaluation                                                                              //
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -601,39 +647,22 @@ double KNN_evaluate
 )
 
 {
-    double correct = 0.0;
-    integer adder;
-
-    switch(mode)
-    {
-        case kOla_TEN_FOLD_CROSS_VALIDATION:
-            adder = my nInstances / 10;
-            break;
-
-        case kOla_LEAVE_ONE_OUT:
-            if (my nInstances > 1)
-                adder = 1;
-            else
-                adder = 0;
-            break;
-
-        default:
-            adder = 0;
-    }
-    
+    integer adder = KNN_foldSize (me, mode);
     if (adder == 0)
         return -1;
 
-    for (integer begin = 1; begin <= my nInstances; begin += adder)
-    {
-        autoCategories c = KNN_classifyFold (me, my input.get(), fws, k, dist, begin, OlaMIN (begin + adder - 1, my nInstances));
-        for (integer y = 1; y <= c->size; y ++)
-            if (FeatureWeights_areFriends (c->at [y], my output->at [begin + y - 1]))
-                correct += 1.0;
+    integer nfolds = (my nInstances - 1) / adder + 1;
+    std::vector <KNN_fold_t> folds ((size_t) nfolds);
+    for (integer i = 0; i < nfolds; i ++) {
+        integer begin = 1 + i * adder;
+        folds [(size_t) i] = { k, dist, begin, OlaMIN (begin + adder - 1, my nInstances), 0 };
     }
+    KNN_evaluateFolds (me, fws, folds.data(), nfolds);
 
-    correct /= (double) my nInstances;
-    return correct;
+    integer correct = 0;
+    for (integer i = 0; i < nfolds; i ++)
+        correct += folds [(size_t) i]. ncorrect;
+    return (double) correct / (double) my nInstances;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -720,11 +749,33 @@ double KNN_modelSearch
 		soil best = { 0, Melder_iround (dpivot), Melder_iround (dpivot) };
 		autoNUMvector <soil> field ((integer) 0, nseeds - 1);
 
+		integer adder = KNN_foldSize (me, mode);
+		integer nfolds = ( adder == 0 ? 0 : (my nInstances - 1) / adder + 1 );
+		std::vector <KNN_fold_t> folds ((size_t) (nseeds * nfolds));
+
 		while (range > 0) {
+			/*
+				Draw all seeds first, in the same order as always; then evaluate all their folds at once.
+			*/
 			for (integer n = 0; n < nseeds; n++) {
 				field[n].k = Melder_iround (NUMrandomUniform (OlaMAX (pivot - range, 1), OlaMIN (pivot + range, max)));
 				field[n].dist = Melder_iround (NUMrandomUniform (OlaMAX (dpivot - drange, 0), OlaMIN (dpivot + drange, 2)));
-				field[n].performance = KNN_evaluate (me, fws, field[n].k, dists[field[n].dist], mode);
+				for (integer i = 0; i < nfolds; i ++) {
+					integer begin = 1 + i * adder;
+					folds [(size_t) (n * nfolds + i)] = { field[n].k, dists[field[n].dist], begin, OlaMIN (begin + adder - 1, my nInstances), 0 };
+				}
+			}
+			if (nfolds > 0)
+				KNN_evaluateFolds (me, fws, folds.data(), nseeds * nfolds);
+			for (integer n = 0; n < nseeds; n++) {
+				if (nfolds == 0) {
+					field[n].performance = -1;   // as from KNN_evaluate
+					continue;
+				}
+				integer correct = 0;
+				for (integer i = 0; i < nfolds; i ++)
+					correct += folds [(size_t) (n * nfolds + i)]. ncorrect;
+				field[n].performance = (double) correct / (double) my nInstances;
 			}
 
 			integer maxindex = 0;
@@ -968,6 +1019,17 @@ integer KNN_kNeighboursSkipRange
 // Locate k neighbours                                                                     //
 /////////////////////////////////////////////////////////////////////////////////////////////
 
+// The slot of the farthest of the k neighbours found so far (the highest index among equal distances),
+// i.e. the one that has to make way for a nearer one
+static integer KNN_farthestNeighbour (const double *distances, const integer *indices, integer k)
+{
+    integer farthest = 0;
+    for (integer i = 1; i < k; i ++)
+        if (distances [i] > distances [farthest] || (distances [i] == distances [farthest] && indices [i] > indices [farthest]))
+            farthest = i;
+    return farthest;
+}
+
 integer KNN_kNeighbours
 (
     ///////////////////////////////
@@ -1011,14 +1073,19 @@ integer KNN_kNeighbours
         }
         ++ py;
     }
-    maxi = KNN_max(distances, k);
+    /*
+        The k nearest, and among equal distances the lowest indices:
+        every later py has a higher index than those found so far, so it only gets in if it is strictly nearer
+        than the farthest one, which is then replaced.
+    */
+    maxi = KNN_farthestNeighbour (distances, indices, k);
     while (py <= p -> ny) {
         if (py != jy) {
             double d = KNN_distanceEuclidean (j, p, fws, jy, py);
             if (d < distances [maxi]) {
                 distances [maxi] = d;
                 indices [maxi] = py;
-                maxi = KNN_max (distances, k);
+                maxi = KNN_farthestNeighbour (distances, indices, k);
             }
         }
         ++ py;
@@ -1028,8 +1095,225 @@ integer KNN_kNeighbours
         indices [0] = jy;
         return 0;
     }
-    else
-        return ret;
+
+    /*
+        Nearest first, as from KNNIndex_kNeighbours; the votes in KNN_kIndicesToFrequenciesAndDistances depend on the order.
+    */
+    for (integer i = 1; i < ret; i ++) {
+        const double d = distances [i];
+        const integer index = indices [i];
+        integer position = i;
+        while (position > 0 && (distances [position - 1] > d || (distances [position - 1] == d && indices [position - 1] > index))) {
+            distances [position] = distances [position - 1];
+            indices [position] = indices [position - 1];
+            position --;
+        }
+        distances [position] = d;
+        indices [position] = index;
+    }
+    return ret;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Spatial index                                                                           //
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+static integer KNNIndex_buildNode (KNNIndex me, integer first, integer last)
+{
+    const integer inode = ++ my numberOfNodes;
+    structKNNIndexNode& node = my nodes [inode];
+    node. first = first;
+    node. last = last;
+    node. left = node. right = 0;
+    if (last - first + 1 <= KNNIndex_LEAF_SIZE)
+        return inode;
+
+    /*
+        Split along the dimension with the largest spread, at the median.
+    */
+    const constMAT z = my instances -> z.get();
+    integer dimension = 1;
+    double largestSpread = -1.0;
+    for (integer x = 1; x <= z.ncol; x ++) {
+        double minimum = z [my order [first]] [x], maximum = minimum;
+        for (integer i = first + 1; i <= last; i ++) {
+            const double value = z [my order [i]] [x];
+            if (value < minimum)
+                minimum = value;
+            else if (value > maximum)
+                maximum = value;
+        }
+        if (maximum - minimum > largestSpread) {
+            largestSpread = maximum - minimum;
+            dimension = x;
+        }
+    }
+    if (largestSpread <= 0.0)
+        return inode;   // all instances are equal: nothing to split
+    const integer middle = first + (last - first + 1) / 2;
+    std::nth_element (& my order [first], & my order [middle], & my order [last] + 1,
+        [z, dimension] (integer a, integer b) { return z [a] [dimension] < z [b] [dimension]; });
+    node. dimension = dimension;
+    node. split = z [my order [middle]] [dimension];
+    node. left = KNNIndex_buildNode (me, first, middle - 1);
+    node. right = KNNIndex_buildNode (me, middle, last);
+    return inode;
+}
+
+autoKNNIndex KNNIndex_create (PatternList instances)
+{
+    try {
+        autoKNNIndex me = Thing_new (KNNIndex);
+        my instances = instances;
+        my order = newINTVECraw (instances -> ny);
+        for (integer i = 1; i <= instances -> ny; i ++)
+            my order [i] = i;
+        my nodes = newvectorraw <structKNNIndexNode> (2 * instances -> ny);   // every split leaves at least one instance on either side
+        my numberOfNodes = 0;
+        KNNIndex_buildNode (me.get(), 1, instances -> ny);
+        return me;
+    } catch (MelderError) {
+        Melder_throw (U"KNN index not created.");
+    }
+}
+
+typedef struct {
+    constVEC query;
+    constVEC weights;
+    integer exclude;
+    integer k, found;
+    integer *indices;
+    double *distances;   // sorted, nearest first
+} KNNIndex_search_t;
+
+/*
+    The distances are compared after taking the square root, exactly as in KNN_kNeighbours,
+    because two different sums of squares can have the same square root.
+    A sum of squares can safely be abandoned only if it exceeds the square of the k-th distance
+    by more than the rounding error of the square root.
+*/
+static double KNNIndex_search_getSquaredBound (KNNIndex_search_t *search)
+{
+    if (search -> found < search -> k)
+        return INFINITY;
+    const double worst = search -> distances [search -> k - 1];
+    return worst * worst * (1.0 + 4.0 * std::numeric_limits <double>::epsilon ());
+}
+
+static void KNNIndex_searchNode (KNNIndex me, integer inode, KNNIndex_search_t *search)
+{
+    const structKNNIndexNode& node = my nodes [inode];
+    if (node. left == 0) {
+        const constMAT z = my instances -> z.get();
+        for (integer i = node. first; i <= node. last; i ++) {
+            const integer py = my order [i];
+            if (py == search -> exclude)
+                continue;
+            /*
+                The same sum as in KNN_distanceEuclidean, so that equal distances stay equal.
+            */
+            const double bound = KNNIndex_search_getSquaredBound (search);
+            double sum = 0.0;
+            for (integer x = 1; x <= z.ncol; x ++) {
+                sum += OlaSQUARE ((search -> query [x] - z [py] [x]) * search -> weights [x]);
+                if (sum > bound)
+                    break;
+            }
+            if (sum > bound)
+                continue;
+            const double distance = sqrt (sum);
+            const bool full = ( search -> found == search -> k );
+            if (full && (distance > search -> distances [search -> k - 1] ||
+                (distance == search -> distances [search -> k - 1] && py > search -> indices [search -> k - 1])))
+                continue;
+            integer position = ( full ? search -> k - 1 : search -> found ++ );
+            while (position > 0 && (search -> distances [position - 1] > distance ||
+                (search -> distances [position - 1] == distance && search -> indices [position - 1] > py)))
+            {
+                search -> distances [position] = search -> distances [position - 1];
+                search -> indices [position] = search -> indices [position - 1];
+                position --;
+            }
+            search -> distances [position] = distance;
+            search -> indices [position] = py;
+        }
+        return;
+    }
+    const double offset = search -> query [node. dimension] - node. split;
+    const integer nearChild = ( offset < 0.0 ? node. left : node. right );
+    const integer farChild = ( offset < 0.0 ? node. right : node. left );
+    KNNIndex_searchNode (me, nearChild, search);
+    /*
+        Every instance in the far child is at least this far away;
+        equality has to be visited, because it may hold a lower index.
+    */
+    const double planeDistance = OlaSQUARE (offset * search -> weights [node. dimension]);
+    if (planeDistance <= KNNIndex_search_getSquaredBound (search))
+        KNNIndex_searchNode (me, farChild, search);
+}
+
+integer KNNIndex_kNeighbours
+(
+    ///////////////////////////////
+    // Parameters                //
+    ///////////////////////////////
+
+    KNNIndex me,        // the index of the target pattern
+                        //
+    PatternList j,      // source-pattern (where the unknown is located)
+                        //
+    FeatureWeights fws, // feature weights
+                        //
+    integer jy,         // the index of the unknown instance in the source pattern
+                        //
+    integer k,          // the number of sought after neighbours
+                        //
+    integer * indices,  // a pointer to a memory-space big enough for k integers
+                        //
+    double * distances  // a pointer to a memory-space big enough for k doubles
+                        //
+)
+
+{
+    Melder_assert (jy > 0 && jy <= j -> ny);
+    Melder_assert (k > 0 && k <= my instances -> ny);
+    Melder_assert (j -> nx == my instances -> nx);
+
+    KNNIndex_search_t search;
+    search. query = j -> z.row (jy);
+    search. weights = fws -> fweights -> data.row (1);
+    search. exclude = jy;   // as in KNN_kNeighbours
+    search. k = k;
+    search. found = 0;
+    search. indices = indices;
+    search. distances = distances;
+    KNNIndex_searchNode (me, 1, & search);
+
+    if (search. found < 1) {
+        indices [0] = jy;
+        return 0;
+    }
+    return search. found;
+}
+
+KNNIndex KNN_getIndex
+(
+    KNN me
+)
+
+{
+    /*
+        In many dimensions a k-d tree visits nearly every leaf, and the plain scan of KNN_kNeighbours is faster;
+        measured break-even: about 32 instances per cell of a 2^nx grid.
+    */
+    if (Melder_debug == 52) {   // for testing the index against the plain scan
+        my index. reset();
+        return nullptr;
+    }
+    const bool worthwhile = my input && my input -> nx < 40 && ((integer) 32 << my input -> nx) <= my nInstances;
+    if (! my index && worthwhile)
+        my index = KNNIndex_create (my input.get());
+    return my index.get();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -1374,6 +1658,7 @@ void KNN_removeInstance
         my nInstances = 0;
         my input.reset();
         my output.reset();
+        my index.reset();
         return;
     }
 
@@ -1392,6 +1677,7 @@ void KNN_removeInstance
 	my input = newPattern.move();
 	my output -> removeItem (y);
 	my nInstances--;
+	my index.reset();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -1429,6 +1715,7 @@ void KNN_shuffleInstances
 	my nInstances = new_output->size;
 	my input = std::move (new_input);
 	my output = std::move (new_output);
+	my index.reset();
 }
 
 
@@ -42,6 +42,41 @@
 #include "FeatureWeights.h"
 #include "gsl_siman.h"
 
+/////////////////////////////////////////////////////
+// Spatial index                                   //
+/////////////////////////////////////////////////////
+
+/*
+	A k-d tree over the rows of a KNN's instance base. The tree itself does not depend
+	on the feature weights; these are applied during the search, so that the answers
+	are exactly those of KNN_kNeighbours. The index is not saved: a KNN builds it on the
+	first classification if the instance base is large for its dimension,
+	and KNN_learn and KNN_removeInstance discard it.
+*/
+#define KNNIndex_LEAF_SIZE  8
+
+typedef struct {
+	integer first, last;   // the range of the node's instances in `order`
+	integer left, right;   // the child nodes; 0 for a leaf
+	integer dimension;
+	double split;   // the left child has values <= split in `dimension`, the right child values >= split
+} structKNNIndexNode;
+
+Thing_define (KNNIndex, Thing) {
+	PatternList instances;   // a reference to the KNN's input
+	autoINTVEC order;   // instance numbers, grouped by node
+	autovector <structKNNIndexNode> nodes;
+	integer numberOfNodes;
+};
+
+autoKNNIndex KNNIndex_create (PatternList instances);
+
+// Locate k neighbours; the same answers as KNN_kNeighbours, in the same order
+integer KNNIndex_kNeighbours
+(
+    KNNIndex me, PatternList j, FeatureWeights fws, integer jy, integer k, integer *indices, double *distances
+);
+
 /////////////////////////////////////////////////////
 // Praat specifics                                 //
 /////////////////////////////////////////////////////
@@ -90,6 +125,13 @@ int KNN_learn
     int ordering        // ordering <- SHUFFLE?
 );
 
+// The spatial index of the current instance base, built on first use;
+// null if a plain scan would be faster (or if Melder_debug is 52)
+KNNIndex KNN_getIndex
+(
+    KNN me
+);
+
 // Classification - To Categories
 autoCategories KNN_classifyToCategories
 (
@@ -207,7 +249,7 @@ integer KNN_kNeighboursSkipRange
                         // pattern
 );
 
-// Locate k neighbours
+// Locate k neighbours, nearest first (and lowest index first among equal distances)
 integer KNN_kNeighbours
 (
     PatternList j,      // source-pattern (where the unknown is located)
@@ -25,6 +25,8 @@ oo_DEFINE_CLASS (KNN, Daata)
 	oo_OBJECT (Categories, 0, output)
 
 	#if oo_DECLARING
+		autoKNNIndex index;   // not saved; see KNN_getIndex
+
 		void v_info ()
 			override;
 	#endif
@@ -28,26 +28,7 @@
 #include "KNN.h"
 #include "KNN_threads.h"
 #include "OlaP.h"
-
-// Threading disabled
-/*
-// Linux... 
-#if defined (__linux__)
-    #define __USE_GNU
-    #include <sched.h>
-// BSD-style OSes
-#elif defined (__APPLE__)    
-    #include <sys/types.h>
-    #include <sys/sysctl.h>
-#endif
-// Non-pthreaders, Windows
-#ifdef _WIN32
-    #include <windows.h>
-// The rest of the pack
-#else
-    #include <pthread.h>
-#endif
-*/
+#include "MelderThread.h"
 
 
 /////////////////////////////////////////////////////
@@ -56,86 +37,7 @@
 
 int KNN_getNumberOfCPUs ()
 {
-    return(1);
-    
-    // Threading disabled
-    /*
-    int ncpus = 0;
-// Linux... 
-#if defined (__linux__)
-    cpu_set_t * cpuset = (cpu_set_t *) malloc(sizeof(cpu_set_t));
-    if(cpuset)
-    {
-        sched_getaffinity(0, sizeof(cpu_set_t), cpuset);
-        for(int cpu = 0; cpu <= CPU_SETSIZE; ++cpu) 
-            if(CPU_ISSET(cpu, cpuset))
-                ++ncpus;
-        free(cpuset);
-    }
-    Melder_assert(ncpus >= 1);
-// BSD-style OSes
-#elif defined (__APPLE__)
-    int mib[2];
-    size_t len = sizeof(ncpus);
-            
-    mib[0] = CTL_HW;
-    mib[1] = HW_NCPU;
-    sysctl(mib, 2, &ncpus, &len, 0, 0);
-// Non-pthreaders, Windows
-#elif defined (_WIN32)
-    typedef BOOL (WINAPI *LPFN_GLPI)
-        (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION, PDWORD);
-  
-    BOOL done, rc;
-    DWORD returnLength, byteOffset;
-    PSYSTEM_LOGICAL_PROCESSOR_INFORMATION buffer, ptr;
-    LPFN_GLPI Glpi;
-
-    Glpi = (LPFN_GLPI) GetProcAddress(GetModuleHandle(TEXT("kernel32")), "GetLogicalProcessorInformation");
-
-    if(!Glpi) 
-        return(1);
-    
-    done = false;
-    buffer = nullptr;
-    returnLength = 0;
-
-    while(!done) 
-    {
-        rc = Glpi(buffer, &returnLength);
-        if(!rc) 
-        {
-            if(GetLastError() == ERROR_INSUFFICIENT_BUFFER) 
-            {
-                if(buffer) 
-                    free(buffer);
-                return (1);
-            } 
-            else done = true;
-        }
-        byteOffset = 0;
-        ptr=buffer;
-        while (byteOffset < returnLength) 
-        {
-            switch (ptr->Relationship) 
-            {
-                case RelationProcessorCore:
-                        ++ncpus;
-                default:
-            }
-            byteOffset += sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
-            ++ptr;
-        }
-    }
-    free(buffer);
-    ncpus = 1;
-// Unknown OS
-#else 
-    ncpus = 1;
-#endif
-    Melder_assert(ncpus >= 1);
-    return(ncpus);
-    */
+    return MelderThread_getNumberOfProcessors ();
 }
 
 
@@ -144,6 +46,29 @@ int KNN_getNumberOfCPUs ()
 // KNN_threadDistribution                          //
 /////////////////////////////////////////////////////
 
+Thing_define (KNN_thread_Args, Thing) { public:
+	void * (* function) (void *);
+	void * input;
+	void * result;
+	bool failed;
+};
+
+Thing_implement (KNN_thread_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE KNN_thread (KNN_thread_Args me)
+{
+	/*
+		An exception must not leave a thread;
+		the error is rethrown by KNN_threadDistribution, on the calling thread.
+	*/
+	try {
+		my result = my function (my input);
+	} catch (MelderError) {
+		my failed = true;
+	}
+	MelderThread_RETURN;
+}
+
 void * KNN_threadDistribution
 (   
     void * (* function) (void *), 
@@ -161,30 +86,36 @@ void * KNN_threadDistribution
         return((void *) error);
     }
 
-    if(nthreads > 1)
-    {
-#ifdef _WIN32
-        // Threading disabled
-        /*
-        HANDLE hHandle[nthreads];
-        for(int i = 0; i < nthreds; ++)
-            hHandle[i] = CreateThread(nullptr, 0, function, input[i], 0, nullptr);
-        while(nthreads--)
-            WaitForSingleObject(hHandle[nthreds], INFINITE);
-        */
-#else
-        // Threading disabled
-        /*
-        pthread_t thread_ids[nthreads];
-        for(int i = 0; i < nthreads; ++i)
-            pthread_create(&thread_ids[i], nullptr, function, input[i]);
-        while(nthreads--)
-            pthread_join(thread_ids[nthreads], nullptr);
-        return nullptr;
-        */
-#endif
+	std::vector <autoKNN_thread_Args> args ((size_t) nthreads);
+	for (int i = 0; i < nthreads; i ++) {
+		args [(size_t) i] = Thing_new (KNN_thread_Args);
+		args [(size_t) i] -> function = function;
+		args [(size_t) i] -> input = input [i];
+	}
+	MelderThread_run (KNN_thread, args.data(), nthreads);
+
+	bool failed = false;
+	for (int i = 0; i < nthreads; i ++)
+		if (args [(size_t) i] -> failed)
+			failed = true;
+	if (failed) {
+		for (int i = 0; i < nthreads; i ++)
+			free (args [(size_t) i] -> result);
+		Melder_throw (U"kNN: not all threads could finish.");
+	}
+
+	/*
+		Report the first error, in thread order; the others are freed.
+	*/
+	void *result = nullptr;
+	for (int i = 0; i < nthreads; i ++) {
+		if (! args [(size_t) i] -> result)
+			continue;
+		if (result)
+			free (args [(size_t) i] -> result);
+		else
+			result = args [(size_t) i] -> result;
 	}
-	void *result = function (input [0]);
 	return result;
 }
 
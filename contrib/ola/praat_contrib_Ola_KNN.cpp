@@ -234,6 +234,7 @@ DO
 	MODIFY_EACH (KNN)
 		my input.reset();
 		my output.reset();
+		my index.reset();
 		my nInstances = 0;
 	MODIFY_EACH_END
 }
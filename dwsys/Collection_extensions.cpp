@@ -159,13 +159,13 @@ void OrderedOfString_initWithSequentialNumbers (StringList me, integer n) {
 }
 
 void OrderedOfString_changeStrings (StringList me, char32 *search, char32 *replace, int maximumNumberOfReplaces, integer *nmatches, integer *nstringmatches, bool use_regexp) {
-	regexp *compiled_search = nullptr;
 	try {
+		regexp *compiled_search = nullptr;
 		Melder_require (search, U"The search string should not be empty.");
 		Melder_require (replace, U"The replace string should not be empty.");
 
 		if (use_regexp)
-			compiled_search = CompileRE_throwable (search, 0);
+			compiled_search = CompileRE_cached (search, 0);
 		for (integer i = 1; i <= my size; i ++) {
 			SimpleString ss = my at [i];
 			integer nmatches_sub;
@@ -183,11 +183,7 @@ void OrderedOfString_changeStrings (StringList me, char32 *search, char32 *repla
 				(*nstringmatches) ++;
 			}
 		}
-		if (use_regexp)
-			free (compiled_search);
 	} catch (MelderError) {
-		if (use_regexp)
-			free (compiled_search);
 		Melder_throw (U"Replace not completed.");
 	}
 }
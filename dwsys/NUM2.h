@@ -1129,6 +1129,14 @@ void NUMfft_backward (NUMfft_Table table, VEC data);
 	sequence by n.
 */
 
+void NUMfft_forward (NUMfft_Table table, VEC data, VEC scratch);
+void NUMfft_backward (NUMfft_Table table, VEC data, VEC scratch);
+/*
+	As above, but the caller supplies the scratch space (at least n values)
+	that the two-argument versions take from the table itself;
+	the table is then only read, so that several threads can share it.
+*/
+
 /**** Compatibility with NR fft's */
 
 void NUMforwardRealFastFourierTransform (VEC data);
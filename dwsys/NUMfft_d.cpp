@@ -74,6 +74,24 @@ void NUMfft_backward (NUMfft_Table me, VEC data) {
 	drftb1 (my n, data.begin(), my trigcache.begin(), my trigcache.begin() + my n, my splitcache.begin());
 }
 
+void NUMfft_forward (NUMfft_Table me, VEC data, VEC scratch) {
+	if (my n == 1) {
+		return;
+	}
+	Melder_assert (my n == data.size);
+	Melder_assert (scratch.size >= my n);
+	drftf1 (my n, data.begin(), scratch.begin(), my trigcache.begin() + my n, my splitcache.begin());
+}
+
+void NUMfft_backward (NUMfft_Table me, VEC data, VEC scratch) {
+	if (my n == 1) {
+		return;
+	}
+	Melder_assert (my n == data.size);
+	Melder_assert (scratch.size >= my n);
+	drftb1 (my n, data.begin(), scratch.begin(), my trigcache.begin() + my n, my splitcache.begin());
+}
+
 void NUMfft_Table_init (NUMfft_Table me, integer n) {
 	my n = n;
 	my trigcache = newVECzero (3 * n);
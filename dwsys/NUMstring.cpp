@@ -37,13 +37,9 @@ autoVEC VEC_createFromString (conststring32 s) {
 
 char32 *strstr_regexp (conststring32 string, conststring32 search_regexp) {
 	char32 *charp = nullptr;
-	regexp *compiled_regexp = CompileRE_throwable (search_regexp, 0);
-
-	if (ExecRE (compiled_regexp, nullptr, string, nullptr, false, U'\0', U'\0', nullptr, nullptr)) {
+	regexp *compiled_regexp = CompileRE_cached (search_regexp, 0);
+	if (ExecRE (compiled_regexp, nullptr, string, nullptr, false, U'\0', U'\0', nullptr, nullptr))
 		charp = compiled_regexp -> startp [0];
-	}
-
-	free (compiled_regexp);
 	return charp;
 }
 
@@ -81,7 +77,7 @@ static autostring32vector string32vector_searchAndReplace_regexp (string32vector
 
 	integer nmatches_sub = 0;
 
-	regexp *compiledRE = CompileRE_throwable (searchRE, 0);
+	regexp *compiledRE = CompileRE_cached (searchRE, 0);
 
 	autostring32vector result (me.size);
 
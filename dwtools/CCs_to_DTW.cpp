@@ -121,4 +121,19 @@ autoDTW CCs_to_DTW (CC me, CC thee, double coefficientWeight, double logEnergyWe
 	}
 }
 
+autoTable CCs_to_Table_DTWDistances (OrderedOf<structCC> *me, double sakoeChibaBand, int localSlope, int frameDistance) {
+	try {
+		OrderedOf<structMatrix> matrices;
+		for (integer iobject = 1; iobject <= my size; iobject ++) {
+			autoMatrix m = CC_to_Matrix (my at [iobject]);
+			Thing_setName (m.get(), my at [iobject] -> name.get());
+			matrices. addItem_move (m.move());
+		}
+		autoTable thee = Matrices_to_Table_DTWDistances (& matrices, sakoeChibaBand, localSlope, frameDistance);
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (U"Table with DTW distances not created from CCs.");
+	}
+}
+
 /* End of file CCs_to_DTW.cpp */
@@ -49,4 +49,10 @@ autoDTW CCs_to_DTW (CC me, CC thee, double coefficientWeight, double logEnergyWe
 	at least one of the four weights != 0
 */
 
+autoTable CCs_to_Table_DTWDistances (OrderedOf<structCC> *me, double sakoeChibaBand, int localSlope, int frameDistance);
+/*
+	The DTW distances between all pairs of CCs, with the coefficients c[1..] as frame vectors.
+	See Matrices_to_Table_DTWDistances.
+*/
+
 #endif /* _CCs_to_DTW_h_ */
@@ -41,6 +41,7 @@
 #include "Sound_extensions.h"
 #include "NUM2.h"
 #include "NUMmachar.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "DTW_def.h"
@@ -778,6 +779,28 @@ void DTW_drawDistancesAlongPath (DTW me, Graphics g, double xmin, double xmax, d
 /*
 	metric = 1...n (sum (a_i^n))^(1/n)
 */
+static double Matrices_getFrameDistance (Matrix me, integer iframe, Matrix thee, integer jframe, double metric) {
+	/*
+		First divide distance by maximum to prevent overflow when metric
+		is a large number.
+		d = (x^n)^(1/n) may overflow if x>1 & n >>1 even if d would not overflow!
+	*/
+	double dmax = 0.0, d = 0.0;
+	for (integer k = 1; k <= my ny; k ++) {
+		double dtmp = fabs (my z [k] [iframe] - thy z [k] [jframe]);
+		if (dtmp > dmax)
+			dmax = dtmp;
+	}
+	if (dmax > 0) {
+		for (integer k = 1; k <= my ny; k ++) {
+			double dtmp = fabs (my z [k] [iframe] - thy z [k] [jframe]) / dmax;
+			d +=  pow (dtmp, metric);
+		}
+	}
+	d = dmax * pow (d, 1.0 / metric);
+	return d / my ny; // == d * dy / ymax
+}
+
 autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd, int slope, double metric) {
 	try {
 		Melder_require (thy ny == my ny, U"Column sizes should be equal.");
@@ -785,27 +808,8 @@ autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd,
 		autoDTW him = DTW_create (my xmin, my xmax, my nx, my dx, my x1, thy xmin, thy xmax, thy nx, thy dx, thy x1);
 		autoMelderProgress progess (U"Calculate distances");
 		for (integer i = 1; i <= my nx; i ++) {
-			for (integer j = 1; j <= thy nx; j ++) {
-				/*
-					First divide distance by maximum to prevent overflow when metric
-					is a large number.
-					d = (x^n)^(1/n) may overflow if x>1 & n >>1 even if d would not overflow!
-				*/
-				double dmax = 0.0, d = 0.0;
-				for (integer k = 1; k <= my ny; k ++) {
-					double dtmp = fabs (my z [k] [i] - thy z [k] [j]);
-					if (dtmp > dmax)
-						dmax = dtmp;
-				}
-				if (dmax > 0) {
-					for (integer k = 1; k <= my ny; k ++) {
-						double dtmp = fabs (my z [k] [i] - thy z [k] [j]) / dmax;
-						d +=  pow (dtmp, metric);
-					}
-				}
-				d = dmax * pow (d, 1.0 / metric);
-				his z [i] [j] = d / my ny; // == d * dy / ymax
-			}
+			for (integer j = 1; j <= thy nx; j ++)
+				his z [i] [j] = Matrices_getFrameDistance (me, i, thee, j, metric);
 			if ((i % 10) == 1) {
 				Melder_progress (0.999 * i / my nx, U"Calculate distances: column ", i, U" from ", my nx, U".");
 			}
@@ -817,23 +821,22 @@ autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd,
 	}
 }
 
+static autoMatrix Spectrogram_to_Matrix_dB (Spectrogram me) {
+	autoMatrix thee = Spectrogram_to_Matrix (me);
+	// Take log10 for dB's (4e-10 scaling not necessary)
+	for (integer i = 1; i <= thy ny; i ++) {
+		for (integer j = 1; j <= thy nx; j ++)
+			thy z [i] [j] = 10 * log10 (thy z [i] [j]);
+	}
+	return thee;
+}
+
 autoDTW Spectrograms_to_DTW (Spectrogram me, Spectrogram thee, bool matchStart, bool matchEnd, int slope, double metric) {
 	try {
 		Melder_require (my xmin == thy xmin && my ymax == thy ymax && my ny == thy ny, U"The number of frequencies and/or frequency ranges should be equal.");
 
-		autoMatrix m1 = Spectrogram_to_Matrix (me);
-		autoMatrix m2 = Spectrogram_to_Matrix (thee);
-
-		// Take log10 for dB's (4e-10 scaling not necessary)
-
-		for (integer i = 1; i <= my ny; i ++) {
-			for (integer j = 1; j <= my nx; j ++)
-				m1 -> z [i] [j] = 10 * log10 (m1 -> z [i] [j]);
-		}
-		for (integer i = 1; i <= thy ny; i ++) {
-			for (integer j = 1; j <= thy nx; j ++)
-				m2 -> z [i] [j] = 10 * log10 (m2 -> z [i] [j]);
-		}
+		autoMatrix m1 = Spectrogram_to_Matrix_dB (me);
+		autoMatrix m2 = Spectrogram_to_Matrix_dB (thee);
 
 		autoDTW him = Matrices_to_DTW (m1.get(), m2.get(), matchStart, matchEnd, slope, metric);
 		return him;
@@ -973,7 +976,7 @@ autoMatrix DTW_to_Matrix_cumulativeDistances (DTW me, double sakoeChibaBand, int
     }
 }
 
-static void DTW_relaxConstraints (DTW me, double band, int slope, double *relaxedBand, int *relaxedSlope) {
+static void DTW_relaxConstraints (SampledXY me, double band, int slope, double *relaxedBand, int *relaxedSlope) {
 	(void) slope;
 	double dtw_slope = (my ymax - my ymin - band) / (my xmax - my xmin - band);
 	dtw_slope = dtw_slope+1.0; // fake instruction t avoid compiler warning
@@ -981,7 +984,17 @@ static void DTW_relaxConstraints (DTW me, double band, int slope, double *relaxe
 	*relaxedSlope = 1;
 }
 
-static void DTW_checkSlopeConstraints (DTW me, double band, int slope) {
+static bool DTW_canMeetSlopeConstraints (SampledXY me, double band, int slope) {
+	double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 } ;
+	double dtw_slope = (my ymax - my ymin - band) / (my xmax - my xmin - band);
+	if (slope < 1 || slope > 4 || (dtw_slope == 0.0 && slope != 1))
+		return false;
+	if (dtw_slope < 1.0)
+		dtw_slope = 1.0 / dtw_slope;
+	return dtw_slope <= slopes [slope];
+}
+
+static void DTW_checkSlopeConstraints (SampledXY me, double band, int slope) {
     try {
         double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 } ;
         double dtw_slope = (my ymax - my ymin - band) / (my xmax - my xmin - band);
@@ -997,50 +1010,322 @@ static void DTW_checkSlopeConstraints (DTW me, double band, int slope) {
     }
 }
 
-static void DTW_Polygon_setUnreachableParts (DTW me, Polygon thee, integer **psi) {
-    try {
-        double eps = my dx / 100.0;   // safe enough
-        double dtw_slope = (my ymax - my ymin) / (my xmax - my xmin);
-
-        double xmin, xmax, ymin, ymax;
-        Polygon_getExtrema (thee, & xmin, & xmax, & ymin, & ymax);
-        // if the Polygon and the DTW don't overlap everything is unreachable!
-        if (xmax <= my xmin || xmin >= my xmax || ymax <= my ymin || ymin >= my ymax) {
-            Melder_throw (U"DTW and Polygon don't overlap.");
-        }
-        // find border "above" polygon
-        for (integer ix = 1; ix <= my nx; ix ++) {
-            double x = my x1 + (ix - 1) * my dx;
-            integer iystart = Melder_ifloor (dtw_slope * ix * (my dx / my dy)) + 1;
-            for (integer iy = iystart + 1; iy <= my ny; iy ++) {
-                double y = my y1 + (iy - 1) * my dy;
-                if (Polygon_getLocationOfPoint (thee, x, y, eps) == Polygon_OUTSIDE) {
-                    for (integer k = iy; k <= my ny; k ++)
-                        psi [k] [ix] =  DTW_UNREACHABLE;
-                    break;
-                }
-            }
-        }
-        // find border "below" polygon
-        for (integer ix = 2; ix <= my nx; ix ++) {
-            double x = my x1 + (ix - 1) * my dx;
-            integer iystart = Melder_ifloor (dtw_slope * ix * (my dx / my dy));   // start 1 lower
-            if (iystart > my ny) iystart = my ny;
-            for (integer iy = iystart - 1; iy >= 1; iy --) {
-                double y = my y1 + (iy - 1) * my dy;
-                if (Polygon_getLocationOfPoint (thee, x, y, eps) == Polygon_OUTSIDE) {
-                    for (integer k = iy; k >= 1; k --)
-                        psi [k] [ix] = DTW_UNREACHABLE;
-                    break;
-                }
-            }
-        }
-    } catch (MelderError) {
-        Melder_throw (me, U" cannot set unreachable parts.");
-    }
+/*
+	Banded storage for the path finder.
+	Cells outside the search region (a Sakoe-Chiba band or any other Polygon) can never be part of the path,
+	so for column ix we only store the cells with row numbers ylow [ix] ... yhigh [ix].
+	Their local distances, cumulative distances and path directions are stored contiguously, column after column.
+	Memory therefore grows with the area of the band instead of with nx * ny, and the local distances
+	only have to be computed inside the band.
+	The columns 1...colto also store row 1, column 1 stores rows 1...rowto and column nx stores row ny,
+	because the path finder needs the cumulative distances of these cells even if they cannot be reached.
+*/
+struct structDTW_Band {
+	integer nx, ny, numberOfCells;
+	integer rowto, colto;
+	autoINTVEC ylow, yhigh, offset, reachableLow, reachableHigh;
+	autoVEC distances, cumulativeDistances;
+	autovector <int8> directions;
+
+	bool contains (integer iy, integer ix) {
+		return ix >= 1 && ix <= our nx && iy >= our ylow [ix] && iy <= our yhigh [ix];
+	}
+	integer cell (integer iy, integer ix) {
+		return our offset [ix] + iy - our ylow [ix];
+	}
+	double& distance (integer iy, integer ix) {
+		return our distances [our cell (iy, ix)];
+	}
+	double& delta (integer iy, integer ix) {
+		return our cumulativeDistances [our cell (iy, ix)];
+	}
+	integer psi (integer iy, integer ix) {
+		return our contains (iy, ix) ? our directions [our cell (iy, ix)] : DTW_UNREACHABLE;
+	}
+	bool isReachable (integer iy, integer ix) {
+		const integer direction = our psi (iy, ix);
+		return direction != DTW_UNREACHABLE && direction != DTW_FORBIDDEN;
+	}
+};
+typedef struct structDTW_Band *DTW_Band;
+
+/*
+	Precondition: the column vectors have room for at least grid -> nx elements.
+	Allocates nothing, so that the storage can be reused.
+*/
+static void DTW_Band_setColumnRanges (DTW_Band me, SampledXY grid, Polygon thee, int localSlope) {
+	double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 };
+	Melder_require (localSlope > 0 && localSlope < 5,
+		U"Local slope parameter is illegal.");
+	const integer nx = my nx = grid -> nx, ny = my ny = grid -> ny;
+	/*
+		If localSlope == 1 the start of the path is within 10% of the minimum duration.
+	*/
+	const integer delta_xy = std::min (nx, ny) / 10;
+	my rowto = std::min (localSlope == 1 ? delta_xy : Melder_ifloor (slopes [localSlope]) + 1, ny);
+	my colto = std::min (localSlope == 1 ? delta_xy : Melder_ifloor (slopes [localSlope]) + 1, nx);
+
+	double xmin, xmax, ymin, ymax;
+	Polygon_getExtrema (thee, & xmin, & xmax, & ymin, & ymax);
+	Melder_require (! (xmax <= grid -> xmin || xmin >= grid -> xmax || ymax <= grid -> ymin || ymin >= grid -> ymax),
+		U"DTW and Polygon don't overlap.");
+	/*
+		Find, for each column, the border "above" and the border "below" the polygon.
+		Only the cells strictly in between can be reached.
+	*/
+	const double eps = grid -> dx / 100.0;   // safe enough
+	const double dtw_slope = (grid -> ymax - grid -> ymin) / (grid -> xmax - grid -> xmin);
+	my numberOfCells = 0;
+	for (integer ix = 1; ix <= nx; ix ++) {
+		const double x = grid -> x1 + (ix - 1) * grid -> dx;
+		integer above = ny + 1;
+		const integer iystart_above = Melder_ifloor (dtw_slope * ix * (grid -> dx / grid -> dy)) + 1;
+		for (integer iy = iystart_above + 1; iy <= ny; iy ++) {
+			const double y = grid -> y1 + (iy - 1) * grid -> dy;
+			if (Polygon_getLocationOfPoint (thee, x, y, eps) == Polygon_OUTSIDE) {
+				above = iy;
+				break;
+			}
+		}
+		integer below = 0;
+		if (ix > 1) {
+			const integer iystart_below = std::min (Melder_ifloor (dtw_slope * ix * (grid -> dx / grid -> dy)), ny);   // start 1 lower
+			for (integer iy = iystart_below - 1; iy >= 1; iy --) {
+				const double y = grid -> y1 + (iy - 1) * grid -> dy;
+				if (Polygon_getLocationOfPoint (thee, x, y, eps) == Polygon_OUTSIDE) {
+					below = iy;
+					break;
+				}
+			}
+		}
+		/*
+			Row 1 and column 1 are unreachable, except for the begin parts of the first column and the first row.
+		*/
+		integer low = below + 1, high = above - 1;
+		if (ix == 1) {
+			low = std::max (low, (integer) 2);
+			high = std::min (high, my rowto);
+		} else if (ix > my colto) {
+			low = std::max (low, (integer) 2);
+		}
+		my reachableLow [ix] = low;
+		my reachableHigh [ix] = high;
+		integer storageLow = low, storageHigh = high;
+		if (ix == 1) {
+			storageLow = 1;
+			storageHigh = std::max (my rowto, (integer) 1);
+		} else if (ix <= my colto) {
+			storageLow = 1;
+			storageHigh = std::max (high, (integer) 1);
+		}
+		if (ix == nx) {
+			storageLow = std::min (storageLow, ny);
+			storageHigh = ny;
+		}
+		if (storageHigh < storageLow)
+			storageHigh = storageLow - 1;
+		my ylow [ix] = storageLow;
+		my yhigh [ix] = storageHigh;
+		my offset [ix] = my numberOfCells + 1;
+		my numberOfCells += storageHigh - storageLow + 1;
+	}
+}
+
+/*
+	Precondition: the cell vectors have room for at least my numberOfCells elements.
+*/
+static void DTW_Band_initDirections (DTW_Band me, int localSlope) {
+	for (integer ix = 1; ix <= my nx; ix ++) {
+		for (integer iy = my ylow [ix]; iy <= my yhigh [ix]; iy ++) {
+			int8 direction = DTW_UNREACHABLE;
+			if (iy >= my reachableLow [ix] && iy <= my reachableHigh [ix]) {
+				if (ix == 1)
+					direction = ( localSlope != 1 ? DTW_Y : DTW_START );
+				else if (iy == 1)
+					direction = ( localSlope != 1 ? DTW_X : DTW_START );
+				else
+					direction = 0;
+			}
+			my directions [my cell (iy, ix)] = direction;
+		}
+	}
+}
+
+static void DTW_Band_init (DTW_Band me, SampledXY grid, Polygon thee, int localSlope) {
+	my ylow = newINTVECraw (grid -> nx);
+	my yhigh = newINTVECraw (grid -> nx);
+	my offset = newINTVECraw (grid -> nx);
+	my reachableLow = newINTVECraw (grid -> nx);
+	my reachableHigh = newINTVECraw (grid -> nx);
+	DTW_Band_setColumnRanges (me, grid, thee, localSlope);
+	my distances = newVECraw (my numberOfCells);
+	my cumulativeDistances = newVECraw (my numberOfCells);
+	my directions = newvectorraw <int8> (my numberOfCells);
+	DTW_Band_initDirections (me, localSlope);
+}
+
+/*
+	Precondition: the local distances inside the band have been computed.
+	The path is stored in path [1..pathLength]; path must have room for nx + ny - 1 elements.
+*/
+static void DTW_Band_findPath (DTW_Band me, int localSlope, DTW_Path path, integer *pathLength, double *weightedDistance, bool showProgress) {
+	const integer nx = my nx, ny = my ny;
+	my cumulativeDistances.part (1, my numberOfCells) <<= my distances.part (1, my numberOfCells);
+	/*
+		Make begin parts of first column and first row reachable.
+	*/
+	if (localSlope != 1) {
+		for (integer iy = 2; iy <= my rowto; iy ++)
+			my delta (iy, 1) = my delta (iy - 1, 1) + my distance (iy, 1);
+		for (integer ix = 2; ix <= my colto; ix ++)
+			my delta (1, ix) = my delta (1, ix - 1) + my distance (1, ix);
+	}
+
+	// Forward pass.
+	for (integer j = 2; j <= nx; j ++) {
+		for (integer i = std::max (my ylow [j], (integer) 2); i <= my yhigh [j]; i ++) {
+			if (! my isReachable (i, j))
+				continue;
+			double g, gmin = DTW_BIG;
+			integer direction = 0;
+			if (my isReachable (i - 1, j - 1)) {
+				gmin = my delta (i - 1, j - 1) + 2.0 * my distance (i, j);
+				direction = DTW_XANDY;
+			} else if (my isReachable (i, j - 1)) {
+				gmin = my delta (i, j - 1) + my distance (i, j);
+				direction = DTW_X;
+			} else if (my isReachable (i - 1, j)) {
+				gmin = my delta (i - 1, j) + my distance (i, j);
+				direction = DTW_Y;
+			} else {
+				continue;   // isolated point
+			}
+
+			switch (localSlope) {
+			case 1: { // no restriction
+				if (my isReachable (i, j - 1) && ((g = my delta (i, j - 1) + my distance (i, j)) < gmin)) {
+					gmin = g;
+					direction = DTW_X;
+				}
+				if (my isReachable (i - 1, j) && ((g = my delta (i - 1, j) + my distance (i, j)) < gmin)) {
+					gmin = g;
+					direction = DTW_Y;
+				}
+			}
+			break;
+
+			// P = 1/2
+
+			case 2: {
+				if (my isReachable (i - 1, j - 3) && my psi (i, j - 1) == DTW_X && my psi (i, j - 2) == DTW_XANDY &&
+					(g = my delta (i - 1, j - 3) + 2.0 * my distance (i, j - 2) + my distance (i, j - 1) + my distance (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_X;
+				}
+				if (my isReachable (i - 1, j - 2) && my psi (i, j - 1) == DTW_XANDY &&
+					(g = my delta (i - 1, j - 2) + 2.0 * my distance (i, j - 1) + my distance (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_X;
+				}
+				if (my isReachable (i - 2, j - 1) && my psi (i - 1, j) == DTW_XANDY &&
+					(g = my delta (i - 2, j - 1) + 2.0 * my distance (i - 1, j) + my distance (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_Y;
+				}
+				if (my isReachable (i - 3, j - 1) && my psi (i - 1, j) == DTW_Y && my psi (i - 2, j) == DTW_XANDY &&
+					(g = my delta (i - 3, j - 1) + 2.0 * my distance (i - 2, j) + my distance (i - 1, j) + my distance (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_Y;
+				}
+			}
+			break;
+
+			// P = 1
+
+			case 3: {
+				if (my isReachable (i - 1, j - 2) && my psi (i, j - 1) == DTW_XANDY &&
+					(g = my delta (i - 1, j - 2) + 2.0 * my distance (i, j - 1) + my distance (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_X;
+				}
+				if (my isReachable (i - 2, j - 1) && my psi (i - 1, j) == DTW_XANDY &&
+					(g = my delta (i - 2, j - 1) + 2.0 * my distance (i - 1, j) + my distance (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_Y;
+				}
+			}
+			break;
+
+			// P = 2
+
+			case 4: {
+				if (my isReachable (i - 2, j - 3) && my psi (i, j - 1) == DTW_XANDY && my psi (i - 1, j - 2) == DTW_XANDY &&
+					(g = my delta (i - 2, j - 3) + 2.0 * my distance (i - 1, j - 2) + 2.0 * my distance (i, j - 1) + my distance (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_X;
+				}
+				if (my isReachable (i - 3, j - 2) && my psi (i - 1, j) == DTW_XANDY && my psi (i - 2, j - 1) == DTW_XANDY &&
+					(g = my delta (i - 3, j - 2) + 2.0 * my distance (i - 2, j - 1) + 2.0 * my distance (i - 1, j) + my distance (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_Y;
+				}
+			}
+			break;
+			default:
+			break;
+			}
+			Melder_assert (direction != 0);
+			my directions [my cell (i, j)] = direction;
+			my delta (i, j) = gmin;
+		}
+		if (showProgress && (j % 10) == 2)
+			Melder_progress (0.999 * j / nx, U"Calculate time warp: frame ", j, U" from ", nx, U".");
+	}
+
+	// Find minimum at end of path and trace back.
+
+	integer iy = ny;
+	double minimum = my delta (iy, nx);
+	for (integer i = ny - 1; i > 0; i --) {
+		if (! my isReachable (i, nx)) {
+			break;   // we're in unreachable places
+		} else if (my delta (i, nx) < minimum) {
+			minimum = my delta (iy = i, nx);
+		}
+	}
+
+	integer pathIndex = nx + ny - 1;   // maximum path length
+	*weightedDistance = minimum / (nx + ny);
+	path [pathIndex]. y = iy;
+	integer ix = path [pathIndex]. x = nx;
+
+	// Fill path backwards.
+
+	while (ix > 1) {
+		const integer direction = my psi (iy, ix);
+		if (direction == DTW_XANDY) {
+			ix --;
+			iy --;
+		} else if (direction == DTW_X) {
+			ix --;
+		} else if (direction == DTW_Y) {
+			iy --;
+		} else if (direction == DTW_START) {
+			break;
+		}
+		if (pathIndex < 2 || iy < 1)
+			break;
+		path [-- pathIndex]. x = ix;
+		path [pathIndex]. y = iy;
+	}
+
+	*pathLength = nx + ny - 1 - pathIndex + 1;
+	if (pathIndex > 1) {
+		for (integer j = 1; j <= *pathLength; j ++)
+			path [j] = path [pathIndex ++];
+	}
 }
 
-#define DTW_ISREACHABLE(y,x) ((psi [y] [x] != DTW_UNREACHABLE) && (psi [y] [x] != DTW_FORBIDDEN))
 static void DTW_findPath_special (DTW me, bool matchStart, bool matchEnd, int slope, autoMatrix *cumulativeDists) {
     (void) matchStart;
     (void) matchEnd;
@@ -1059,102 +1344,116 @@ static void getIntersectionPoint (double x1, double y1, double x2, double y2, do
     *y3 = a * *x3 + y1 - a * x1;
 }
 
-autoPolygon DTW_to_Polygon (DTW me, double band, int slope) {
-    try {
+/*
+	The search region only depends on the domains of the DTW, so it can also be determined
+	for a grid of frames for which no distances have been stored.
+	Precondition: thee has room for 8 points; the constraints can be met.
+	Allocates nothing, so that the Polygon can be reused.
+*/
+static void DTW_setRegion (SampledXY me, double band, int slope, Polygon thee) {
+	double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 };
+	if (band <= 0) {
+		if (slope == 1) {
+			thy numberOfPoints = 4;
+			thy x [1] = my xmin;
+			thy y [1] = my ymin;
+			thy x [2] = my xmin;
+			thy y [2] = my ymax;
+			thy x [3] = my xmax;
+			thy y [3] = my ymax;
+			thy x [4] = my xmax;
+			thy y [4] = my ymin;
+		} else {
+			thy numberOfPoints = 4;
+			thy x [1] = my xmin;
+			thy y [1] = my ymin;
+			thy x [3] = my xmax;
+			thy y [3] = my ymax;
+			double x, y;
+			getIntersectionPoint (my xmin, my ymin, my xmax, my ymax, slopes [slope], & x, & y);
+			if (x < my xmin) x = my xmin;
+			if (x > my xmax) x = my xmax;
+			if (y < my ymin) y = my ymin;
+			if (y > my ymax) y = my ymax;
+			thy x [2] = x;
+			thy y [2] = y;
+			getIntersectionPoint (my xmin, my ymin, my xmax, my ymax, 1.0 / slopes [slope], & x, & y);
+			if (x < my xmin) x = my xmin;
+			if (x > my xmax) x = my xmax;
+			if (y < my ymin) y = my ymin;
+			if (y > my ymax) y = my ymax;
+			thy x [4] = x;
+			thy y [4] = y;
+		}
+	} else {
+		if (slope == 1) {
+			thy numberOfPoints = 6;
+			thy x [1] = my xmin;
+			thy y [1] = my ymin;
+			thy x [2] = my xmin;
+			thy y [2] = my ymin + band;
+			thy x [3] = my xmax - band;
+			thy y [3] = my ymax;
+			thy x [4] = my xmax;
+			thy y [4] = my ymax;
+			thy x [5] = my xmax;
+			thy y [5] = my ymax - band;
+			thy x [6] = my xmin + band;
+			thy y [6] = my ymin;
+		} else {
+			thy numberOfPoints = 8;
+			double x, y;
+			thy x [1] = my xmin;
+			thy y [1] = my ymin;
+			thy x [2] = my xmin;
+			thy y [2] = my ymin + band;
+			getIntersectionPoint (my xmin, my ymin + band, my xmax - band, my ymax, slopes [slope], & x, & y);
+			if (x < my xmin) x = my xmin;
+			if (x > my xmax) x = my xmax;
+			if (y < my ymin) y = my ymin;
+			if (y > my ymax) y = my ymax;
+			thy x [3] = x;
+			thy y [3] = y;
+			thy x [4] = my xmax - band;
+			thy y [4] = my ymax;
+			thy x [5] = my xmax;
+			thy y [5] = my ymax;
+			thy x [6] = my xmax;
+			thy y [6] = my ymax - band;
+			getIntersectionPoint (my xmin + band, my ymin, my xmax, my ymax - band, 1.0 / slopes [slope], & x, & y);
+			if (x < my xmin) x = my xmin;
+			if (x > my xmax) x = my xmax;
+			if (y < my ymin) y = my ymin;
+			if (y > my ymax) y = my ymax;
+			thy x [7] = x;
+			thy y [7] = y;
+			thy x [8] = my xmin + band;
+			thy y [8] = my ymin;
+		}
+	}
+}
+
+static autoPolygon _DTW_to_Polygon (SampledXY me, double band, int slope) {
+	try {
 		try {
 			DTW_checkSlopeConstraints (me, band, slope);
 		} catch (MelderError) {
 			DTW_relaxConstraints (me, band, slope, & band, & slope);
 			Melder_flushError ();
 		}
-			
-        double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 } ;
-        if (band <= 0) {
-            if (slope == 1) {
-                autoPolygon thee = Polygon_create (4);
-                thy x [1] = my xmin;
-				thy y [1] = my ymin;
-                thy x [2] = my xmin;
-				thy y [2] = my ymax;
-                thy x [3] = my xmax;
-				thy y [3] = my ymax;
-                thy x [4] = my xmax;
-				thy y [4] = my ymin;
-                return thee;
-            } else {
-                autoPolygon thee = Polygon_create (4);
-                thy x [1] = my xmin;
-				thy y [1] = my ymin;
-                thy x [3] = my xmax;
-				thy y [3] = my ymax;
-                double x, y;
-                getIntersectionPoint (my xmin, my ymin, my xmax, my ymax, slopes [slope], & x, & y);
-                if (x < my xmin) x = my xmin;
-                if (x > my xmax) x = my xmax;
-                if (y < my ymin) y = my ymin;
-                if (y > my ymax) y = my ymax;
-                thy x [2] = x;
-                thy y [2] = y;
-                getIntersectionPoint (my xmin, my ymin, my xmax, my ymax, 1.0 / slopes [slope], & x, & y);
-                if (x < my xmin) x = my xmin;
-                if (x > my xmax) x = my xmax;
-                if (y < my ymin) y = my ymin;
-                if (y > my ymax) y = my ymax;
-                thy x [4] = x;
-                thy y [4] = y;
-                return thee;
-            }
-        } else {
-            if (slope == 1) {
-                autoPolygon thee = Polygon_create (6);
-                thy x [1] = my xmin;
-				thy y [1] = my ymin;
-                thy x [2] = my xmin;
-				thy y [2] = my ymin + band;
-                thy x [3] = my xmax - band;
-				thy y [3] = my ymax;
-                thy x [4] = my xmax;
-				thy y [4] = my ymax;
-                thy x [5] = my xmax;
-				thy y [5] = my ymax - band;
-                thy x [6] = my xmin + band;
-				thy y [6] = my ymin;
-                return thee;
-            } else {
-                autoPolygon thee = Polygon_create (8);
-                double x, y;
-                thy x [1] = my xmin;
-				thy y [1] = my ymin;
-                thy x [2] = my xmin;
-				thy y [2] = my ymin + band;
-                getIntersectionPoint (my xmin, my ymin + band, my xmax - band, my ymax, slopes [slope], & x, & y);
-                if (x < my xmin) x = my xmin;
-                if (x > my xmax) x = my xmax;
-                if (y < my ymin) y = my ymin;
-                if (y > my ymax) y = my ymax;
-                thy x [3] = x;
-                thy y [3] = y;
-                thy x [4] = my xmax - band;
-				thy y [4] = my ymax;
-                thy x [5] = my xmax;
-				thy y [5]= my ymax;
-                thy x [6] = my xmax;
-				thy y [6] = my ymax - band;
-                getIntersectionPoint (my xmin + band, my ymin, my xmax, my ymax - band, 1.0 / slopes [slope], & x, & y);
-                if (x < my xmin) x = my xmin;
-                if (x > my xmax) x = my xmax;
-                if (y < my ymin) y = my ymin;
-                if (y > my ymax) y = my ymax;
-                thy x [7] = x;
-                thy y [7] = y;
-                thy x [8] = my xmin + band;
-				thy y [8] = my ymin;
-                return thee;
-            }
-        }
-    } catch (MelderError) {
-        Melder_throw (me, U" no Polygon created.");
-    }
+		autoPolygon region = Polygon_create (8);
+		DTW_setRegion (me, band, slope, region.get());
+		autoPolygon thee = Polygon_create (region -> numberOfPoints);
+		thy x.all()  <<=  region -> x.part (1, region -> numberOfPoints);
+		thy y.all()  <<=  region -> y.part (1, region -> numberOfPoints);
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U" no Polygon created.");
+	}
+}
+
+autoPolygon DTW_to_Polygon (DTW me, double band, int slope) {
+	return _DTW_to_Polygon (me, band, slope);
 }
 
 autoMatrix DTW_Polygon_to_Matrix_cumulativeDistances (DTW me, Polygon thee, int localSlope) {
@@ -1177,221 +1476,294 @@ void DTW_findPath_bandAndSlope (DTW me, double sakoeChibaBand, int localSlope, a
 }
 
 void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatrix *cumulativeDists) {
-    try {
-        double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 };
-        // if localSlope == 1 start of path is within 10% of minimum duration. Starts farther away
-        integer delta_xy = std::min (my nx, my ny) / 10; // if localSlope == 1 start within 10% of
+	try {
+		structDTW_Band band;
+		DTW_Band_init (& band, me, thee, localSlope);
+		for (integer ix = 1; ix <= my nx; ix ++)
+			for (integer iy = band.ylow [ix]; iy <= band.yhigh [ix]; iy ++)
+				band.distance (iy, ix) = my z [iy] [ix];
+		autoMelderProgress progress (U"Find path");
+		DTW_Band_findPath (& band, localSlope, my path, & my pathLength, & my weightedDistance, true);
+		DTW_Path_recode (me);
+		if (cumulativeDists) {
+			/*
+				Outside the band the cumulative distances equal the local distances.
+			*/
+			autoMatrix him = Matrix_create (my xmin, my xmax, my nx, my dx, my x1,
+				my ymin, my ymax, my ny, my dy, my y1);
+			for (integer i = 1; i <= my ny; i ++) {
+				for (integer j = 1; j <= my nx; j ++)
+					his z [i] [j] = ( band.contains (i, j) ? band.delta (i, j) : my z [i] [j] );
+			}
+			*cumulativeDists = him.move();
+		}
+	} catch (MelderError) {
+		Melder_throw (me, U": cannot find path.");
+	}
+}
 
-		Melder_require (localSlope > 0 && localSlope < 5, 
-			U"Local slope parameter is illegal.");
+double Matrices_getDTWDistance (Matrix me, Matrix thee, double sakoeChibaBand, int localSlope, double metric) {
+	try {
+		Melder_require (thy ny == my ny, U"Column sizes should be equal.");
+		/*
+			The same grid as the DTW of Matrices_to_DTW: prototype on the y-axis, test on the x-axis.
+		*/
+		autoSampledXY grid = Thing_new (SampledXY);
+		SampledXY_init (grid.get(), thy xmin, thy xmax, thy nx, thy dx, thy x1, my xmin, my xmax, my nx, my dx, my x1);
+		autoPolygon region = _DTW_to_Polygon (grid.get(), sakoeChibaBand, localSlope);
+		structDTW_Band band;
+		DTW_Band_init (& band, grid.get(), region.get(), localSlope);
+		for (integer ix = 1; ix <= band.nx; ix ++)
+			for (integer iy = band.ylow [ix]; iy <= band.yhigh [ix]; iy ++)
+				band.distance (iy, ix) = Matrices_getFrameDistance (me, iy, thee, ix, metric);
+		autoNUMvector <structDTW_Path> path (1, band.nx + band.ny - 1);
+		integer pathLength;
+		double weightedDistance;
+		autoMelderProgress progress (U"Find path");
+		DTW_Band_findPath (& band, localSlope, path.peek(), & pathLength, & weightedDistance, true);
+		return weightedDistance;
+	} catch (MelderError) {
+		Melder_throw (U"DTW distance between matrices not computed.");
+	}
+}
 
-        autoNUMmatrix<double> delta (-2, my ny, -2, my nx);
-        autoNUMmatrix<integer> psi (-2, my ny, -2, my nx);
-        for (integer i = 1; i <= my ny; i ++) {
-            for (integer j = 1; j <= my nx; j ++) {
-                delta [i] [j] = my z [i] [j];
-            }
-        }
-        // start by making the outside unreachable
-        for (integer k = -2; k <= 1; k ++) {
-           for (integer j = -2; j <= my nx; j ++) {
-               // delta [k] [j] = DTW_BIG;
-                psi [k] [j] = DTW_UNREACHABLE;
-            }
-            for (integer i = 1; i <= my ny; i ++) {
-             //   delta [i] [k] = DTW_BIG;
-                psi [i] [k] = DTW_UNREACHABLE;
-            }
-        }
-
-        // Make begin part of first column reachable
-        integer rowto = delta_xy;
-        if (localSlope != 1) {
-			rowto = Melder_ifloor (slopes [localSlope]) + 1;
+double Spectrograms_getDTWDistance (Spectrogram me, Spectrogram thee, double sakoeChibaBand, int localSlope, double metric) {
+	try {
+		Melder_require (my xmin == thy xmin && my ymax == thy ymax && my ny == thy ny, U"The number of frequencies and/or frequency ranges should be equal.");
+		autoMatrix m1 = Spectrogram_to_Matrix_dB (me);
+		autoMatrix m2 = Spectrogram_to_Matrix_dB (thee);
+		return Matrices_getDTWDistance (m1.get(), m2.get(), sakoeChibaBand, localSlope, metric);
+	} catch (MelderError) {
+		Melder_throw (U"DTW distance between Spectrograms not computed.");
+	}
+}
+
+/*
+	Frame distances for the DTW distances between many pairs.
+	The frames are stored as rows, so that both frames are contiguous in memory;
+	the pairwise summation is unrolled, which allows the compiler to vectorize it.
+*/
+static double frames_getEuclideanDistance (constVEC x, constVEC y) {
+	PAIRWISE_SUM (double, sumsq, integer, x.size,
+		const double *px = & x [1];
+		const double *py = & y [1],
+		(*px - *py) * (*px - *py),
+		(px += 1, py += 1)
+	)
+	return sqrt (sumsq) / x.size;   // scaled as in Matrices_getFrameDistance
+}
+
+static double frames_getCosineDistance (constVEC x, double xnorm, constVEC y, double ynorm) {
+	if (xnorm == 0.0 || ynorm == 0.0)
+		return ( xnorm == ynorm ? 0.0 : 1.0 );
+	PAIRWISE_SUM (double, inner, integer, x.size,
+		const double *px = & x [1];
+		const double *py = & y [1],
+		*px * *py,
+		(px += 1, py += 1)
+	)
+	return 1.0 - inner / (xnorm * ynorm);
+}
+
+Thing_define (Matrices_into_DTWDistances_Args, Thing) { public:
+	OrderedOf<structMatrix> *matrices;
+	constMAT frames;   // the frames of all objects as rows, object after object
+	constVEC norms;   // the norms of the frames, only for the cosine distance
+	constINTVEC frameOffset;   // row frameOffset [iobject] + iframe contains frame iframe of object iobject
+	constINTVEC left, right;   // the pairs
+	VEC distances;   // the result, one value per pair
+	integer firstPair, lastPair;
+	double sakoeChibaBand;
+	int localSlope, frameDistance;
+	bool isMainThread, failed;
+	volatile int *cancelled;
+	/*
+		The workspace of this thread, allocated by the calling thread and reused for all pairs,
+		because the threads should not allocate.
+	*/
+	autoSampledXY grid;
+	autoPolygon region;
+	structDTW_Band band;
+	autoNUMvector <structDTW_Path> path;
+};
+
+Thing_implement (Matrices_into_DTWDistances_Args, Thing, 0);
+
+/*
+	Sets the grid and the search region of the pair, and the column ranges of the band.
+	Relaxes the constraints as DTW_to_Polygon does, but silently.
+*/
+static void Matrices_into_DTWDistances_setBand (Matrix prototype, Matrix test, double sakoeChibaBand, int localSlope,
+	SampledXY grid, Polygon region, DTW_Band band)
+{
+	/*
+		Prototype on the y-axis and test on the x-axis, as in Matrices_getDTWDistance.
+	*/
+	SampledXY_init (grid, test -> xmin, test -> xmax, test -> nx, test -> dx, test -> x1,
+		prototype -> xmin, prototype -> xmax, prototype -> nx, prototype -> dx, prototype -> x1);
+	if (DTW_canMeetSlopeConstraints (grid, sakoeChibaBand, localSlope))
+		DTW_setRegion (grid, sakoeChibaBand, localSlope, region);
+	else
+		DTW_setRegion (grid, 0.0, 1, region);
+	DTW_Band_setColumnRanges (band, grid, region, localSlope);
+}
+
+static MelderThread_RETURN_TYPE Matrices_into_DTWDistances (Matrices_into_DTWDistances_Args me) {
+	/*
+		An exception must not leave a thread;
+		the error is rethrown by Matrices_to_Table_DTWDistances, on the calling thread.
+	*/
+	try {
+		for (integer ipair = my firstPair; ipair <= my lastPair; ipair ++) {
+			if (my isMainThread) {
+				try {
+					Melder_progress ((ipair - my firstPair + 0.5) / (my lastPair - my firstPair + 1),
+						U"DTW distances: pair ", ipair - my firstPair + 1, U" from ", my lastPair - my firstPair + 1, U".");
+				} catch (MelderError) {
+					*my cancelled = 1;
+					throw;
+				}
+			} else if (*my cancelled) {
+				MelderThread_RETURN;
+			}
+			const integer iprototype = my left [ipair], itest = my right [ipair];
+			Matrices_into_DTWDistances_setBand (my matrices -> at [iprototype], my matrices -> at [itest],
+				my sakoeChibaBand, my localSlope, my grid.get(), my region.get(), & my band);
+			DTW_Band_initDirections (& my band, my localSlope);
+			const integer xoffset = my frameOffset [itest], yoffset = my frameOffset [iprototype];
+			for (integer ix = 1; ix <= my band.nx; ix ++) {
+				constVEC xframe = my frames.row (xoffset + ix);
+				if (my frameDistance == DTW_FRAMEDISTANCE_COSINE) {
+					const double xnorm = my norms [xoffset + ix];
+					for (integer iy = my band.ylow [ix]; iy <= my band.yhigh [ix]; iy ++)
+						my band.distance (iy, ix) = frames_getCosineDistance (xframe, xnorm, my frames.row (yoffset + iy), my norms [yoffset + iy]);
+				} else {
+					for (integer iy = my band.ylow [ix]; iy <= my band.yhigh [ix]; iy ++)
+						my band.distance (iy, ix) = frames_getEuclideanDistance (xframe, my frames.row (yoffset + iy));
+				}
+			}
+			integer pathLength;
+			DTW_Band_findPath (& my band, my localSlope, my path.peek(), & pathLength, & my distances [ipair], false);
 		}
-        for (integer iy = 2; iy <= rowto; iy ++) {
-            if (localSlope != 1) {
-                delta [iy] [1] = delta [iy - 1] [1] + my z [iy] [1];
-                psi [iy] [1] = DTW_Y;
-            } else {
-                psi [iy] [1] = DTW_START; // will be adapted by DTW_Polygon_setUnreachableParts
-            }
-        }
-        // Make begin part of first row reachable
-        integer colto = delta_xy;
-        if (localSlope != 1) 
-			colto = Melder_ifloor (slopes [localSlope]) + 1;
-
-        for (integer ix = 2; ix <= colto; ix ++) {
-            if (localSlope != 1) {
-                delta [1] [ix] = delta [1] [ix -1] + my z [1] [ix];
-                psi [1] [ix] = DTW_X;
-            } else {
-                psi [1] [ix] = DTW_START; // will be adapted by DTW_Polygon_setUnreachableParts
-           }
-        }
-
-        // Now we can set the unreachable parts from the Polygon
-        DTW_Polygon_setUnreachableParts (me, thee, psi.peek());
-
-        // Forward pass.
-        integer numberOfIsolatedPoints = 0;
-        autoMelderProgress progress (U"Find path");
-        for (integer j = 2; j <= my nx; j ++) {
-            for (integer i = 2; i <= my ny; i ++) {
-                if (! DTW_ISREACHABLE (i, j)) continue;
-                double g, gmin = DTW_BIG;
-                integer direction = 0;
-                if (DTW_ISREACHABLE (i - 1, j - 1)) {
-                    gmin = delta [i - 1] [j - 1] + 2.0 * my z [i] [j];
-                    direction = DTW_XANDY;
-                } else if (DTW_ISREACHABLE (i, j - 1)) {
-                    gmin = delta [i] [j - 1] + my z [i] [j];
-                    direction = DTW_X;
-                } else if (DTW_ISREACHABLE (i - 1, j)) {
-                    gmin = delta [i - 1] [j] + my z [i] [j];
-                    direction = DTW_Y;
-                } else {
-                    numberOfIsolatedPoints ++;
-                    continue;
-                }
-
-                switch (localSlope) {
-                case 1:  { // no restriction
-                    if (DTW_ISREACHABLE (i, j - 1) && ((g = delta [i] [j - 1] + my z [i] [j]) < gmin)) {
-                        gmin = g;
-                        direction = DTW_X;
-                    }
-                    if (DTW_ISREACHABLE (i - 1, j) && ((g = delta [i - 1] [j] + my z [i] [j]) < gmin)) {
-                        gmin = g;
-                        direction = DTW_Y;
-                    }
-                }
-                break;
-
-                // P = 1/2
-
-                case 2: { // P = 1/2
-                    if (DTW_ISREACHABLE (i - 1, j - 3) && psi [i] [j - 1] == DTW_X && psi [i] [j - 2] == DTW_XANDY &&
-                        (g = delta [i-1] [j-3] + 2.0 * my z [i] [j-2] + my z [i] [j-1] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_X;
-                    }
-                    if (DTW_ISREACHABLE (i - 1, j - 2) && psi [i] [j - 1] == DTW_XANDY &&
-                        (g = delta [i - 1] [j - 2] + 2.0 * my z [i] [j - 1] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_X;
-                    }
-                    if (DTW_ISREACHABLE (i - 2, j - 1) && psi [i - 1] [j] == DTW_XANDY &&
-                        (g = delta [i - 2] [j - 1] + 2.0 * my z [i - 1] [j] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_Y;
-                    }
-                    if (DTW_ISREACHABLE (i - 3, j - 1) && psi [i - 1] [j] == DTW_Y && psi [i - 2] [j] == DTW_XANDY &&
-                        (g = delta [i-3] [j-1] + 2.0 * my z [i-2] [j] + my z [i-1] [j] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_Y;
-                    }
-                }
-                break;
-
-                // P = 1
-
-                case 3: {
-                    if (DTW_ISREACHABLE (i - 1, j - 2) && psi [i] [j - 1] == DTW_XANDY &&
-                        (g = delta [i - 1] [j - 2] + 2.0 * my z [i] [j - 1] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_X;
-                    }
-                    if (DTW_ISREACHABLE (i - 2, j - 1) && psi [i - 1] [j] == DTW_XANDY &&
-                        (g = delta [i - 2] [j - 1] + 2.0 * my z [i - 1] [j] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_Y;
-                    }
-                }
-                break;
-
-                // P = 2
-
-                case 4: {
-                    if (DTW_ISREACHABLE (i - 2, j - 3) && psi [i] [j - 1] == DTW_XANDY && psi [i - 1] [j - 2] == DTW_XANDY &&
-                        (g = delta [i-2] [j-3] + 2.0 * my z [i-1] [j-2] + 2.0 * my z [i] [j-1] + my z [i] [j]) < gmin) {
-                            gmin = g;
-                            direction = DTW_X;
-                    }
-                    if (DTW_ISREACHABLE (i - 3, j - 2) && psi [i - 1] [j] == DTW_XANDY && psi [i - 2] [j - 1] == DTW_XANDY &&
-                        (g = delta [i-3] [j-2] + 2.0 * my z [i-2] [j-1] + 2.0 * my z [i-1] [j] + my z [i] [j]) < gmin) {
-                            gmin = g;
-                            direction = DTW_Y;
-                    }
-                }
-                break;
-                default:
-                break;
-                }
-                Melder_assert (direction != 0);
-                psi [i] [j] = direction;
-                delta [i] [j] = gmin;
-            }
-            if ((j % 10) == 2)
-                Melder_progress (0.999 * j / my nx, U"Calculate time warp: frame ", j, U" from ", my nx, U".");
-        }
-
-        // Find minimum at end of path and trace back.
-
-        integer iy = my ny;
-        double minimum = delta [iy] [my nx];
-        for (integer i = my ny - 1; i > 0; i --) {
-            if (! DTW_ISREACHABLE (i, my nx)) {
-                break;   // we're in unreachable places
-            } else if (delta [i] [my nx] < minimum) {
-                minimum = delta [iy = i] [my nx];
-            }
-        }
-
-        integer pathIndex = my nx + my ny - 1;   // maximum path length
-        my weightedDistance = minimum / (my nx + my ny);
-        my path [pathIndex]. y = iy;
-        integer ix = my path [pathIndex]. x = my nx;
-
-        // Fill path backwards.
-
-        while (ix > 1) {
-            if (psi [iy] [ix] == DTW_XANDY) {
-                ix --;
-                iy --;
-            } else if (psi [iy] [ix] == DTW_X) {
-                ix --;
-            } else if (psi [iy] [ix] == DTW_Y) {
-                iy --;
-            } else if (psi [iy] [ix] == DTW_START) {
-                break;
-            }
-            if (pathIndex < 2 || iy < 1) break;
-            //Melder_assert (pathIndex > 1 && iy > 0);
-            my path [-- pathIndex]. x = ix;
-            my path [pathIndex]. y = iy;
-        }
-
-        my pathLength = my nx + my ny - 1 - pathIndex + 1;
-        if (pathIndex > 1) {
-            for (integer j = 1; j <= my pathLength; j ++)
-                my path [j] = my path [pathIndex ++];
-        }
-
-        DTW_Path_recode (me);
-        if (cumulativeDists) {
-            autoMatrix him = Matrix_create (my xmin, my xmax, my nx, my dx, my x1,
-                my ymin, my ymax, my ny, my dy, my y1);
-            for (integer i = 1; i <= my ny; i ++) {
-                for (integer j = 1; j <= my nx; j ++)
-                    his z [i] [j] = delta [i] [j];
-            }
-            *cumulativeDists = him.move();
-        }
-    } catch (MelderError) {
-        Melder_throw (me, U": cannot find path.");
-    }
+	} catch (MelderError) {
+		*my cancelled = 1;   // let the other threads stop as well
+		my failed = true;
+	}
+	MelderThread_RETURN;
+}
+
+autoTable Matrices_to_Table_DTWDistances (OrderedOf<structMatrix> *me, double sakoeChibaBand, int localSlope, int frameDistance) {
+	try {
+		const integer numberOfObjects = my size;
+		Melder_require (numberOfObjects > 1,
+			U"There should be at least two objects.");
+		Melder_require (localSlope > 0 && localSlope < 5,
+			U"Local slope parameter is illegal.");
+		Melder_require (frameDistance == DTW_FRAMEDISTANCE_EUCLIDEAN || frameDistance == DTW_FRAMEDISTANCE_COSINE,
+			U"Unknown frame distance.");
+		integer maximumNumberOfFrames = 0, totalNumberOfFrames = 0;
+		autoINTVEC frameOffset = newINTVECraw (numberOfObjects);
+		for (integer iobject = 1; iobject <= numberOfObjects; iobject ++) {
+			Matrix m = my at [iobject];
+			Melder_require (m -> ny == my at [1] -> ny,
+				U"All objects should have the same number of rows (", my at [1] -> ny, U" for the first object, ", m -> ny, U" for object ", iobject, U").");
+			if (m -> nx > maximumNumberOfFrames)
+				maximumNumberOfFrames = m -> nx;
+			frameOffset [iobject] = totalNumberOfFrames;
+			totalNumberOfFrames += m -> nx;
+		}
+		/*
+			Store the frames as rows, and precompute the norms for the cosine distance.
+		*/
+		autoMAT frames = newMATraw (totalNumberOfFrames, my at [1] -> ny);
+		autoVEC norms = newVECzero (totalNumberOfFrames);
+		for (integer iobject = 1; iobject <= numberOfObjects; iobject ++) {
+			Matrix m = my at [iobject];
+			frames.horizontalBand (frameOffset [iobject] + 1, frameOffset [iobject] + m -> nx) <<= m -> z.transpose();
+		}
+		if (frameDistance == DTW_FRAMEDISTANCE_COSINE)
+			for (integer iframe = 1; iframe <= totalNumberOfFrames; iframe ++)
+				norms [iframe] = NUMnorm (frames.row (iframe), 2.0);
+
+		const integer numberOfPairs = numberOfObjects * (numberOfObjects - 1) / 2;
+		autoINTVEC left = newINTVECraw (numberOfPairs), right = newINTVECraw (numberOfPairs);
+		autoTable thee = Table_createWithColumnNames (numberOfPairs, U"object1 object2 index1 index2 distance");
+		integer ipair = 0;
+		for (integer iobject = 1; iobject < numberOfObjects; iobject ++) {
+			for (integer jobject = iobject + 1; jobject <= numberOfObjects; jobject ++) {
+				left [++ ipair] = iobject;
+				right [ipair] = jobject;
+				Table_setStringValue (thee.get(), ipair, 1, my at [iobject] -> name.get());
+				Table_setStringValue (thee.get(), ipair, 2, my at [jobject] -> name.get());
+				Table_setNumericValue (thee.get(), ipair, 3, iobject);   // names can repeat
+				Table_setNumericValue (thee.get(), ipair, 4, jobject);
+			}
+		}
+		autoVEC distances = newVECzero (numberOfPairs);
+
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads > numberOfPairs) numberOfThreads = numberOfPairs;
+		const integer numberOfPairsPerThread = (numberOfPairs - 1) / numberOfThreads + 1;
+		numberOfThreads = (numberOfPairs - 1) / numberOfPairsPerThread + 1;
+
+		autoMatrices_into_DTWDistances_Args args [16];
+		volatile int cancelled = 0;
+		integer firstPair = 1;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoMatrices_into_DTWDistances_Args arg = Thing_new (Matrices_into_DTWDistances_Args);
+			arg -> matrices = me;
+			arg -> frames = frames.get();
+			arg -> norms = norms.get();
+			arg -> frameOffset = frameOffset.get();
+			arg -> left = left.get();
+			arg -> right = right.get();
+			arg -> distances = distances.get();
+			arg -> firstPair = firstPair;
+			arg -> lastPair = std::min (firstPair + numberOfPairsPerThread - 1, numberOfPairs);
+			arg -> sakoeChibaBand = sakoeChibaBand;
+			arg -> localSlope = localSlope;
+			arg -> frameDistance = frameDistance;
+			arg -> isMainThread = ( ithread == numberOfThreads );
+			arg -> cancelled = & cancelled;
+			/*
+				The band needs as many cells as the largest region of the pairs of this thread.
+			*/
+			arg -> grid = Thing_new (SampledXY);
+			arg -> region = Polygon_create (8);
+			structDTW_Band& band = arg -> band;
+			band.ylow = newINTVECraw (maximumNumberOfFrames);
+			band.yhigh = newINTVECraw (maximumNumberOfFrames);
+			band.offset = newINTVECraw (maximumNumberOfFrames);
+			band.reachableLow = newINTVECraw (maximumNumberOfFrames);
+			band.reachableHigh = newINTVECraw (maximumNumberOfFrames);
+			integer numberOfCells = 0;
+			for (ipair = arg -> firstPair; ipair <= arg -> lastPair; ipair ++) {
+				Matrices_into_DTWDistances_setBand (my at [left [ipair]], my at [right [ipair]],
+					sakoeChibaBand, localSlope, arg -> grid.get(), arg -> region.get(), & band);
+				if (band.numberOfCells > numberOfCells)
+					numberOfCells = band.numberOfCells;
+			}
+			band.distances = newVECraw (numberOfCells);
+			band.cumulativeDistances = newVECraw (numberOfCells);
+			band.directions = newvectorraw <int8> (numberOfCells);
+			arg -> path.reset (1, 2 * maximumNumberOfFrames - 1);
+			args [ithread - 1] = arg.move();
+			firstPair += numberOfPairsPerThread;
+		}
+
+		autoMelderProgress progress (U"DTW distances...");
+		MelderThread_run (Matrices_into_DTWDistances, args, numberOfThreads);
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++)
+			if (args [ithread - 1] -> failed)
+				Melder_throw (U"Not all threads could finish.");
+
+		for (ipair = 1; ipair <= numberOfPairs; ipair ++)
+			Table_setNumericValue (thee.get(), ipair, 5, distances [ipair]);
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (U"Table with DTW distances not created.");
+	}
 }
 
 /* End of file DTW.cpp */
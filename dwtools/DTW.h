@@ -117,6 +117,27 @@ autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd,
 
 autoDTW Spectrograms_to_DTW (Spectrogram me, Spectrogram thee, bool matchStart, bool matchEnd, int slope, double metric);
 
+/*
+	Memory-lean alternatives for Matrices_to_DTW/Spectrograms_to_DTW followed by DTW_findPath_bandAndSlope:
+	only the distances inside the search region are calculated and stored,
+	and the weighted distance of the path is returned instead of a DTW.
+*/
+double Matrices_getDTWDistance (Matrix me, Matrix thee, double sakoeChibaBand, int localSlope, double metric);
+
+double Spectrograms_getDTWDistance (Spectrogram me, Spectrogram thee, double sakoeChibaBand, int localSlope, double metric);
+
+/*
+	The DTW distances between all pairs of a list of objects, calculated in parallel.
+	The frames are the columns of the matrices; the distance between two frames is
+	the Euclidean distance divided by the number of rows (as in Matrices_to_DTW with metric 2)
+	or the cosine distance (1 - cos (angle)).
+	Returns a Table with one row per pair and the columns "object1", "object2" and "distance".
+*/
+#define DTW_FRAMEDISTANCE_EUCLIDEAN 1
+#define DTW_FRAMEDISTANCE_COSINE 2
+
+autoTable Matrices_to_Table_DTWDistances (OrderedOf<structMatrix> *me, double sakoeChibaBand, int localSlope, int frameDistance);
+
 autoDTW Pitches_to_DTW (Pitch me, Pitch thee, double vuv_costs, double time_weight, bool matchStart, bool matchEnd, int slope);
 
 autoDurationTier DTW_to_DurationTier (DTW me);
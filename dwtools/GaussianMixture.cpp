@@ -21,6 +21,7 @@
 */
 #include "Distributions_and_Strings.h"
 #include "GaussianMixture.h"
+#include "MelderThread.h"
 #include "NUMmachar.h"
 #include "NUM2.h"
 #include "Strings_extensions.h"
@@ -59,57 +60,204 @@ double GaussianMixture_getLikelihoodValue (GaussianMixture me, constMAT p, int o
 void GaussianMixture_updateProbabilityMarginals (GaussianMixture me, MAT p);
 integer GaussianMixture_getNumberOfParametersInComponent (GaussianMixture me);
 
-static void GaussianMixture_updateCovariance (GaussianMixture me, integer component, MAT data, MAT p) {
-	integer numberOfRows = data.nrow;
-	if (component < 1 || component > my numberOfComponents) {
-		return;
-	}
-	Covariance thee = my covariances->at [component];
-
-	double mixprob = my mixingProbabilities [component];
-	double gsum = p [numberOfRows + 1] [component];
-	// update the means
+/*
+	The computations that visit every row of the data (the probabilities, the likelihood and the sufficient statistics
+	of the M-step) divide the rows into at most GaussianMixture_MAXIMUM_NUMBER_OF_CHUNKS chunks of consecutive rows,
+	which are divided over the threads. Every chunk accumulates its own sums, and the chunks are added up in order,
+	so that the results do not depend on the number of threads.
+*/
+#define GaussianMixture_MINIMUM_CHUNK_SIZE  1000
+#define GaussianMixture_MAXIMUM_NUMBER_OF_CHUNKS  16
+
+#define GaussianMixture_JOB_PROBABILITIES  1
+#define GaussianMixture_JOB_LIKELIHOOD  2
+#define GaussianMixture_JOB_MEANS  3
+#define GaussianMixture_JOB_COVARIANCES  4
+
+Thing_define (GaussianMixture_chunks_Args, Thing) { public:
+	GaussianMixture gm;
+	constMAT data;
+	constMAT p;   // (numberOfRows + 1) x (numberOfComponents + 1)
+	MAT probabilities;   // the same as p, but only written into by GaussianMixture_JOB_PROBABILITIES
+	int job, criterion;
+	integer firstComponent, lastComponent;
+	integer firstChunk, lastChunk, numberOfChunks;
+	MAT chunkSums;   // [chunk] [sum]
+};
+
+Thing_implement (GaussianMixture_chunks_Args, Thing, 0);
+
+static inline integer GaussianMixture_getCovarianceStride (GaussianMixture me) {
+	return my dimension * (my dimension + 1) / 2;   // the upper triangle; a diagonal covariance uses the first `dimension` elements
+}
 
-	for (integer j = 1; j <= thy numberOfColumns; j ++) {
-		thy centroid [j] = 0.0;
-		for (integer i = 1; i <= numberOfRows; i ++) {
-			double gamma = mixprob * p [i] [component] / p [i] [my numberOfComponents + 1];
-			thy centroid [j] += gamma * data [i] [j] ; // eq. Bishop 9.17
+/*
+	The new probabilities of the components firstComponent..lastComponent (none if firstComponent > lastComponent),
+	the row marginals in the last column, and the sums of the column marginals.
+	The lower Cholesky inverses should have been expanded before.
+*/
+static void GaussianMixture_computeProbabilities_rows (GaussianMixture me, constMAT data, MAT p,
+	integer firstComponent, integer lastComponent, integer firstRow, integer lastRow, VEC const& marginals)
+{
+	const double ln2pid = my dimension * log (NUM2pi);
+	for (integer irow = firstRow; irow <= lastRow; irow ++) {
+		for (integer ic = firstComponent; ic <= lastComponent; ic ++) {
+			Covariance cov = my covariances->at [ic];
+			const double dsq = NUMmahalanobisDistance (cov -> lowerCholeskyInverse.get(), data.row (irow), cov -> centroid.get());
+			p [irow] [ic] = std::max (1e-300, exp (- 0.5 * (ln2pid + cov -> lnd + dsq))); // prevent p from being zero
 		}
-		thy centroid [j] /= gsum;
+		p [irow] [p.ncol] = NUMinner (my mixingProbabilities.get(), p.row (irow).part (1, p.ncol - 1));
+		for (integer ic = 1; ic <= my numberOfComponents; ic ++)
+			marginals [ic] += my mixingProbabilities [ic] * p [irow] [ic] / p [irow] [p.ncol];
 	}
+}
 
-	// update covariance with the new mean
-
-	if (thy numberOfRows == 1) { // 1xn covariance
-		for (integer j = 1; j <= thy numberOfColumns; j ++) {
-			thy data [1] [j] = 0.0;
-		}
-		for (integer i = 1; i <= numberOfRows; i ++) {
-			double gamma = mixprob * p [i] [component] / p [i] [my numberOfComponents + 1];
-			double gdn = gamma / gsum;
-			for (integer j = 1; j <= thy numberOfColumns; j ++) {
-				double xj = thy centroid [j] - data [i] [j];
-				thy data [1] [j] += gdn * xj * xj;
+static double GaussianMixture_getLikelihoodValue_rows (GaussianMixture me, constMAT p, int criterion, integer firstRow, integer lastRow) {
+	longdouble lnp = 0.0;
+	for (integer irow = firstRow; irow <= lastRow; irow ++) {
+		if (criterion == GaussianMixture_CD_LIKELIHOOD) {
+			longdouble psum = 0.0, lnsum = 0.0;
+			for (integer icol = 1; icol <= my numberOfComponents; icol ++) {
+				longdouble pp = my mixingProbabilities [icol] * p [irow] [icol];
+				psum += pp;
+				lnsum += pp * log (pp);
 			}
+			if (psum > 0)
+				lnp += lnsum / psum;
+		} else {
+			double psum = NUMinner (my mixingProbabilities.get(), p.row (irow).part (1, p.ncol - 1));
+			if (psum > 0.0)
+				lnp += (longdouble) log (psum);
 		}
-	} else { // nxn covariance
-		for (integer j = 1; j <= thy numberOfRows; j ++)
-			for (integer k = j; k <= thy numberOfColumns; k ++) {
-				thy data [k] [j] = thy data [j] [k] = 0;
-			}
-		for (integer i = 1; i <= numberOfRows; i ++) {
-			double gamma = mixprob * p [i] [component] / p [i] [my numberOfComponents + 1];
-			double gdn = gamma / gsum; // we cannot divide by nk - 1, this could cause instability
-			for (integer j = 1; j <= thy numberOfColumns; j ++) {
-				double xj = thy centroid [j] - data [i] [j];
-				for (integer k = j; k <= thy numberOfColumns; k ++) {
-					thy data [j] [k] = thy data [k] [j] += gdn * xj * (thy centroid [k] - data [i] [k]);
+	}
+	return (double) lnp;
+}
+
+/*
+	For every component in firstComponent..lastComponent, the sum of gamma * x (eq. Bishop 9.17)
+	or the sum of gamma * (x - centroid) (x - centroid)' (eq. Bishop 9.19), without the division by N(k).
+*/
+static void GaussianMixture_accumulateMoments_rows (GaussianMixture me, constMAT data, constMAT p, bool centralMoments,
+	integer firstComponent, integer lastComponent, integer firstRow, integer lastRow, VEC const& sums)
+{
+	const integer stride = ( centralMoments ? GaussianMixture_getCovarianceStride (me) : my dimension );
+	for (integer ic = firstComponent; ic <= lastComponent; ic ++) {
+		Covariance thee = my covariances->at [ic];
+		const VEC sum = sums.part ((ic - firstComponent) * stride + 1, (ic - firstComponent + 1) * stride);
+		const double mixprob = my mixingProbabilities [ic];
+		for (integer irow = firstRow; irow <= lastRow; irow ++) {
+			const double gamma = mixprob * p [irow] [ic] / p [irow] [p.ncol];
+			const constVEC x = data.row (irow);
+			if (! centralMoments) {
+				for (integer j = 1; j <= my dimension; j ++)
+					sum [j] += gamma * x [j];
+			} else if (thy numberOfRows == 1) {
+				for (integer j = 1; j <= my dimension; j ++) {
+					const double xj = thy centroid [j] - x [j];
+					sum [j] += gamma * xj * xj;
+				}
+			} else {
+				for (integer j = 1, k = 1; j <= my dimension; j ++) {
+					const double gxj = gamma * (thy centroid [j] - x [j]);
+					for (integer m = j; m <= my dimension; m ++, k ++)
+						sum [k] += gxj * (thy centroid [m] - x [m]);
 				}
 			}
 		}
 	}
-	thy numberOfObservations = my mixingProbabilities [component] * numberOfRows;
+}
+
+static MelderThread_RETURN_TYPE GaussianMixture_computeChunks (GaussianMixture_chunks_Args me) {
+	const integer numberOfRows = my p.nrow - 1;
+	for (integer ichunk = my firstChunk; ichunk <= my lastChunk; ichunk ++) {
+		const integer firstRow = 1 + (ichunk - 1) * numberOfRows / my numberOfChunks;
+		const integer lastRow = ichunk * numberOfRows / my numberOfChunks;
+		const VEC sums = my chunkSums.row (ichunk);
+		sums <<= 0.0;
+		if (my job == GaussianMixture_JOB_PROBABILITIES)
+			GaussianMixture_computeProbabilities_rows (my gm, my data, my probabilities, my firstComponent, my lastComponent, firstRow, lastRow, sums);
+		else if (my job == GaussianMixture_JOB_LIKELIHOOD)
+			sums [1] = GaussianMixture_getLikelihoodValue_rows (my gm, my p, my criterion, firstRow, lastRow);
+		else
+			GaussianMixture_accumulateMoments_rows (my gm, my data, my p, my job == GaussianMixture_JOB_COVARIANCES,
+					my firstComponent, my lastComponent, firstRow, lastRow, sums);
+	}
+	MelderThread_RETURN;
+}
+
+/*
+	Runs one job over all rows, and returns the sum of the chunk sums.
+	`probabilities` should be p for GaussianMixture_JOB_PROBABILITIES, and can be empty otherwise.
+*/
+static autoVEC GaussianMixture_sumOverChunks (GaussianMixture me, constMAT data, constMAT p, MAT probabilities, int job, int criterion,
+	integer firstComponent, integer lastComponent, integer numberOfSums)
+{
+	const integer numberOfRows = p.nrow - 1;
+	const integer numberOfChunks = std::max ((integer) 1, std::min (numberOfRows / GaussianMixture_MINIMUM_CHUNK_SIZE, (integer) GaussianMixture_MAXIMUM_NUMBER_OF_CHUNKS));
+	autoMAT chunkSums = newMATraw (numberOfChunks, numberOfSums);
+	const int numberOfThreads = std::max (1, std::min ((int) numberOfChunks, MelderThread_getNumberOfProcessors ()));
+	autoGaussianMixture_chunks_Args args [GaussianMixture_MAXIMUM_NUMBER_OF_CHUNKS];
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoGaussianMixture_chunks_Args arg = Thing_new (GaussianMixture_chunks_Args);
+		arg -> gm = me;
+		arg -> data = data;
+		arg -> p = p;
+		arg -> probabilities = probabilities;
+		arg -> job = job;
+		arg -> criterion = criterion;
+		arg -> firstComponent = firstComponent;
+		arg -> lastComponent = lastComponent;
+		arg -> firstChunk = 1 + (ithread - 1) * numberOfChunks / numberOfThreads;
+		arg -> lastChunk = ithread * numberOfChunks / numberOfThreads;
+		arg -> numberOfChunks = numberOfChunks;
+		arg -> chunkSums = chunkSums.get();
+		args [ithread - 1] = arg.move();
+	}
+	MelderThread_run (GaussianMixture_computeChunks, args, numberOfThreads);
+
+	autoVEC sums = newVECzero (numberOfSums);
+	for (integer ichunk = 1; ichunk <= numberOfChunks; ichunk ++)
+		sums.all()  +=  chunkSums.row (ichunk);
+	return sums;
+}
+
+/*
+	The M-step for the means and covariances of the components firstComponent..lastComponent,
+	given the probabilities and their marginals in p.
+*/
+static void GaussianMixture_updateCovariances (GaussianMixture me, integer firstComponent, integer lastComponent, constMAT data, constMAT p) {
+	Melder_assert (firstComponent >= 1 && lastComponent <= my numberOfComponents);
+	Melder_assert (p.nrow == data.nrow + 1 && p.ncol == my numberOfComponents + 1);
+	const integer numberOfRows = data.nrow;
+
+	autoVEC sums = GaussianMixture_sumOverChunks (me, data, p, MAT (), GaussianMixture_JOB_MEANS, 0,
+			firstComponent, lastComponent, (lastComponent - firstComponent + 1) * my dimension);
+	for (integer ic = firstComponent; ic <= lastComponent; ic ++) {
+		Covariance thee = my covariances->at [ic];
+		const double gsum = p [numberOfRows + 1] [ic];
+		for (integer j = 1; j <= my dimension; j ++)
+			thy centroid [j] = sums [(ic - firstComponent) * my dimension + j] / gsum;
+	}
+
+	// update covariance with the new mean; we cannot divide by nk - 1, this could cause instability
+
+	const integer stride = GaussianMixture_getCovarianceStride (me);
+	sums = GaussianMixture_sumOverChunks (me, data, p, MAT (), GaussianMixture_JOB_COVARIANCES, 0,
+			firstComponent, lastComponent, (lastComponent - firstComponent + 1) * stride);
+	for (integer ic = firstComponent; ic <= lastComponent; ic ++) {
+		Covariance thee = my covariances->at [ic];
+		const double gsum = p [numberOfRows + 1] [ic];
+		const constVEC sum = sums.part ((ic - firstComponent) * stride + 1, (ic - firstComponent + 1) * stride);
+		if (thy numberOfRows == 1) { // 1xn covariance
+			for (integer j = 1; j <= thy numberOfColumns; j ++)
+				thy data [1] [j] = sum [j] / gsum;
+		} else { // nxn covariance
+			for (integer j = 1, k = 1; j <= thy numberOfColumns; j ++)
+				for (integer m = j; m <= thy numberOfColumns; m ++, k ++)
+					thy data [j] [m] = thy data [m] [j] = sum [k] / gsum;
+		}
+		thy numberOfObservations = my mixingProbabilities [ic] * numberOfRows;
+	}
 }
 
 static void GaussianMixture_updateCovariance2 (GaussianMixture me, integer component, constMAT data, constMAT p) {
@@ -746,23 +894,19 @@ void GaussianMixture_TableOfReal_getProbabilities (GaussianMixture me, TableOfRe
 		Melder_assert (p.ncol == my numberOfComponents + 1);
 		Melder_assert (my dimension == thy numberOfColumns);
 		
-		double ln2pid = my dimension * log (NUM2pi);
-
 		integer icb = 1, ice = my numberOfComponents;
 		if (component > 0 && component <= my numberOfComponents) // if component == 0 update all probabilities
 			icb = ice = component;
-		
-		for (integer ic = icb; ic <= ice; ic ++) {
-			Covariance covi = my covariances->at [ic];
-			SSCP_expandLowerCholeskyInverse (covi);
 
-			for (integer i = 1; i <= thy numberOfRows; i++) {
-				double dsq = NUMmahalanobisDistance (covi -> lowerCholeskyInverse.get(), thy data.row (i), covi -> centroid.get());
-				p [i] [ic] = std::max (1e-300, exp (- 0.5 * (ln2pid + covi -> lnd + dsq))); // prevent p from being zero
-			}
-		}
+		// the factorizations are computed once, before the rows are divided over the threads
+
+		for (integer ic = icb; ic <= ice; ic ++)
+			SSCP_expandLowerCholeskyInverse (my covariances->at [ic]);
 
-		GaussianMixture_updateProbabilityMarginals (me, p);
+		autoVEC marginals = GaussianMixture_sumOverChunks (me, thy data.get(), p, p, GaussianMixture_JOB_PROBABILITIES, 0,
+				icb, ice, my numberOfComponents);
+		p.row (p.nrow).part (1, my numberOfComponents) <<= marginals.all();
+		p [p.nrow] [p.ncol] = 0.0;
 	} catch (MelderError) {
 		Melder_throw (me, U" & ", thee, U": no probabilies could be calculated.");
 	}
@@ -809,10 +953,9 @@ void GaussianMixture_TableOfReal_improveLikelihood (GaussianMixture me, TableOfR
 				iter ++;
 				// M-step: 1. new means & covariances
 
-				for (integer im = 1; im <= my numberOfComponents; im ++) {
-					GaussianMixture_updateCovariance (me, im, thy data.get(), p.get());
+				GaussianMixture_updateCovariances (me, 1, my numberOfComponents, thy data.get(), p.get());
+				for (integer im = 1; im <= my numberOfComponents; im ++)
 					GaussianMixture_addCovarianceFraction (me, im, covg.get(), lambda);
-				}
 
 				// M-step: 2. new mixingProbabilities
 				my mixingProbabilities.all() <<= p.row (p.nrow).part (1, p.ncol - 1);
@@ -864,12 +1007,10 @@ integer GaussianMixture_getNumberOfParametersInComponent (GaussianMixture me) {
 void GaussianMixture_updateProbabilityMarginals (GaussianMixture me, MAT p) {
 	Melder_assert (p.ncol == my numberOfComponents + 1);
 	Melder_assert (p.nrow > 1);
-	p.row (p.nrow) <<= 0.0;
-	for (integer irow = 1; irow <= p.nrow - 1; irow ++) {
-		p [irow] [p.ncol] = NUMinner (my mixingProbabilities.get(), p.row (irow).part (1, p.ncol - 1));
-		for (integer icol = 1; icol <= my numberOfComponents; icol ++)
-			p [p.nrow] [icol] += my mixingProbabilities [icol] * p [irow] [icol] / p [irow] [p.ncol];
-	}
+	autoVEC marginals = GaussianMixture_sumOverChunks (me, constMAT (), p, p, GaussianMixture_JOB_PROBABILITIES, 0,
+			1, 0, my numberOfComponents);   // no components, only the marginals
+	p.row (p.nrow).part (1, my numberOfComponents) <<= marginals.all();
+	p [p.nrow] [p.ncol] = 0.0;
 }
 
 autoMAT GaussianMixture_removeComponent_bookkeeping (GaussianMixture me, integer component, constMAT p) {
@@ -896,30 +1037,13 @@ double GaussianMixture_getLikelihoodValue (GaussianMixture me, constMAT p, int c
 	Melder_assert (p.ncol == my numberOfComponents + 1);
 	// Because we try to _maximize_ a criterion, all criteria are negative numbers.
 
-	if (criterion == GaussianMixture_CD_LIKELIHOOD) {
-		longdouble lnpcd = 0.0;
-		for (integer irow = 1; irow <= p.nrow - 1; irow ++) {
-			longdouble psum = 0.0, lnsum = 0.0;
-			for (integer icol = 1; icol <= my numberOfComponents; icol ++) {
-				longdouble pp = my mixingProbabilities [icol] * p [irow] [icol];
-				psum += pp;
-				lnsum += pp * log (pp);
-			}
-			if (psum > 0)
-				lnpcd += lnsum / psum;
-		}
-		return lnpcd;
-	}
+	autoVEC sums = GaussianMixture_sumOverChunks (me, constMAT (), p, MAT (), GaussianMixture_JOB_LIKELIHOOD, criterion, 1, 0, 1);
+	if (criterion == GaussianMixture_CD_LIKELIHOOD)
+		return sums [1];
 
 	// The common factor for all other criteria is the log(likelihood)
 
-	longdouble lnp = 0.0;
-	for (integer irow = 1; irow <= p.nrow - 1; irow ++) {
-		double psum = NUMinner (my mixingProbabilities.get(), p.row (irow).part (1, p.ncol - 1));
-		if (psum > 0.0)
-			lnp += (longdouble) log (psum);
-	}
-
+	const double lnp = sums [1];
 	if (criterion == GaussianMixture_LIKELIHOOD)
 		return lnp;
 
@@ -984,7 +1108,7 @@ autoGaussianMixture GaussianMixture_TableOfReal_to_GaussianMixture_CEMM (Gaussia
 						// M-step for means and covariances
 
 						GaussianMixture_updateProbabilityMarginals (me.get(), p.get());
-						GaussianMixture_updateCovariance (me.get(), component, thy data.get(), p.get());
+						GaussianMixture_updateCovariances (me.get(), component, component, thy data.get(), p.get());
 						if (lambda > 0)
 							GaussianMixture_addCovarianceFraction (me.get(), component, covg.get(), lambda);
 
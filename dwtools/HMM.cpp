@@ -22,6 +22,7 @@
 #include "Distributions_and_Strings.h"
 #include "HMM.h"
 #include "Index.h"
+#include "MelderThread.h"
 #include "NUM2.h"
 #include "Strings_extensions.h"
 
@@ -50,7 +51,7 @@ Thing_implement (HMMStateList, Ordered, 0);
 Thing_implement (HMMObservation, Daata, 0);
 Thing_implement (HMMObservationList, Ordered, 0);
 Thing_implement (HMMBaumWelch, Daata, 0);
-Thing_implement (HMMViterbi, Daata, 0);
+Thing_implement (HMMViterbi, Daata, 1);
 Thing_implement (HMMObservationSequence, Table, 0);
 Thing_implement (HMMObservationSequenceBag, Collection, 0);
 Thing_implement (HMMStateSequence, Strings, 0);
@@ -75,6 +76,8 @@ autoHMMBaumWelch HMMBaumWelch_create (integer nstates, integer nsymbols, integer
 void HMMBaumWelch_getGamma (HMMBaumWelch me);
 autoHMMBaumWelch HMM_forward (HMM me, constINTVEC obs);
 void HMMBaumWelch_reInit (HMMBaumWelch me);
+void HMMBaumWelch_addEstimates (HMMBaumWelch me, HMMBaumWelch thee);
+void HMM_HMMBaumWelch_cacheProbabilities (HMM me, HMMBaumWelch thee);
 void HMM_HMMBaumWelch_getXi (HMM me, HMMBaumWelch thee, constINTVEC obs);
 void HMM_HMMBaumWelch_reestimate (HMM me, HMMBaumWelch thee);
 void HMM_HMMBaumWelch_addEstimate (HMM me, HMMBaumWelch thee, constINTVEC obs);
@@ -227,17 +230,22 @@ autoHMMBaumWelch HMMBaumWelch_create (integer nstates, integer nsymbols, integer
 		my numberOfTimes = my capacity = capacity;
 		my numberOfStates = nstates;
 		my numberOfSymbols = nsymbols;
-		my alpha = newMATzero (nstates, capacity);
-		my beta = newMATzero (nstates, capacity);
+		my alpha = newMATzero (capacity, nstates);
+		my beta = newMATzero (capacity, nstates);
 		my scale = newVECzero (capacity);
-		my xi = newTEN3zero (capacity, nstates, nstates); // TEN3
+		my xi = newMATzero (nstates, nstates);
+		my transitions = newMATzero (nstates, nstates);
+		my transitionsTransposed = newMATzero (nstates, nstates);
+		my emissionsTransposed = newMATzero (nsymbols, nstates);
+		my betaEmission = newVECzero (nstates);
+		my transitionSum = newVECzero (nstates);
 		my aij_num_p0 = newVECzero (nstates + 1);
 		my aij_num = newMATzero (nstates, nstates + 1);
 		my aij_denom_p0 = newVECzero (nstates + 1);
 		my aij_denom =  newMATzero (nstates, nstates + 1);
 		my bik_num = newMATzero (nstates, nsymbols);
 		my bik_denom = newMATzero (nstates, nsymbols);
-		my gamma = newMATzero (nstates, capacity);
+		my gamma = newMATzero (capacity, nstates);
 		return me;
 	} catch (MelderError) {
 		Melder_throw (U"HMMBaumWelch not created.");
@@ -246,8 +254,8 @@ autoHMMBaumWelch HMMBaumWelch_create (integer nstates, integer nsymbols, integer
 
 void HMMBaumWelch_getGamma (HMMBaumWelch me) {
 	for (integer it = 1; it <= my numberOfTimes; it ++) {
-		my gamma.column (it) <<= my alpha.column (it)  *  my beta.column (it);
-		my gamma.column (it)  /=  NUMsum (my gamma.column (it));
+		my gamma.row (it) <<= my alpha.row (it)  *  my beta.row (it);
+		my gamma.row (it)  /=  NUMsum (my gamma.row (it));
 	}
 }
 
@@ -778,6 +786,7 @@ autoHMMObservationSequence HMM_to_HMMObservationSequence (HMM me, integer startS
 autoHMMBaumWelch HMM_forward (HMM me, constINTVEC obs) {
 	try {
 		autoHMMBaumWelch thee = HMMBaumWelch_create (my numberOfStates, my numberOfObservationSymbols, obs.size);
+		HMM_HMMBaumWelch_cacheProbabilities (me, thee.get());
 		HMM_HMMBaumWelch_forward (me, thee.get(), obs);
 		return thee;
 	} catch (MelderError) {
@@ -803,7 +812,7 @@ void HMMBaumWelch_reInit (HMMBaumWelch me) {
 		The _num and _denum matrices are asigned as += in the iteration loop and therefore need to be zeroed
 		at the start of each new iteration.
 		The elements of alpha, beta, scale, gamma & xi are always calculated directly and need not be
-		initialised.
+		initialised; neither do the cached probabilities, which are set by HMM_HMMBaumWelch_cacheProbabilities.
 	*/
 	my aij_num_p0.get () <<= 0.0;
 	my aij_num.get () <<= 0.0;
@@ -813,6 +822,27 @@ void HMMBaumWelch_reInit (HMMBaumWelch me) {
 	my bik_denom.get() <<= 0.0;
 }
 
+void HMM_HMMBaumWelch_cacheProbabilities (HMM me, HMMBaumWelch thee) {
+	/*
+		The forward and backward recursions are matrix-vector products with the transition matrix
+		(without the END state) and with a column of the emission matrix; these need contiguous rows.
+	*/
+	thy transitions.all() <<= my transitionProbs.verticalBand (1, my numberOfStates);
+	thy transitionsTransposed.all() <<= my transitionProbs.verticalBand (1, my numberOfStates).transpose();
+	thy emissionsTransposed.all() <<= my emissionProbs.transpose();
+}
+
+void HMMBaumWelch_addEstimates (HMMBaumWelch me, HMMBaumWelch thee) {
+	my totalNumberOfSequences += thy totalNumberOfSequences;
+	my lnProb += thy lnProb;
+	my aij_num_p0.all()  +=  thy aij_num_p0.all();
+	my aij_num.all()  +=  thy aij_num.all();
+	my aij_denom_p0.all()  +=  thy aij_denom_p0.all();
+	my aij_denom.all()  +=  thy aij_denom.all();
+	my bik_num.all()  +=  thy bik_num.all();
+	my bik_denom.all()  +=  thy bik_denom.all();
+}
+
 static integer HMM_getState_notHidden (HMM me, conststring32 stateLabel) {
 	for (integer istate = 1; istate <= my states -> size; istate ++)
 		if (Melder_cmp (my states -> at [istate] -> label.get(), stateLabel) == 0)
@@ -912,6 +942,52 @@ void HMM_HMMObservationSequenceBag_learn_notHidden (HMM me, HMMObservationSequen
 }
 
 
+/*
+	The observation sequences are divided over the threads, each of which has its own HMMBaumWelch,
+	i.e. its own alpha's and beta's, its own scratch vectors and its own accumulators for the reestimation,
+	all allocated before the threads start.
+*/
+Thing_define (HMM_learn_Args, Thing) { public:
+	HMM hmm;
+	const std::vector <autoStringsIndex> *indices;   // one for each observation sequence
+	integer firstSequence, lastSequence;
+	HMMBaumWelch bw;
+};
+
+Thing_implement (HMM_learn_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE HMM_learn_sequences (HMM_learn_Args me) {
+	HMM hmm = my hmm;
+	HMMBaumWelch bw = my bw;
+	for (integer iseq = my firstSequence; iseq <= my lastSequence; iseq ++) {
+		constINTVEC obs = (*my indices) [(size_t) iseq - 1] -> classIndex.get();
+		integer nobs = obs.size; // convenience
+
+		// Interpretation of unknowns: end of sequence
+
+		integer istart = 1, iend = nobs;
+		while (istart <= nobs) {
+			while (istart <= nobs && obs [istart] == 0)
+				istart ++;
+			if (istart > nobs) break;
+
+			iend = istart + 1;
+			while (iend <= nobs && obs [iend] != 0)
+				iend ++;
+			iend --;
+			bw -> numberOfTimes = iend - istart + 1;
+			bw -> totalNumberOfSequences ++;
+			HMM_HMMBaumWelch_forward (hmm, bw, obs.part (istart, iend)); // get new alphas
+			HMM_HMMBaumWelch_backward (hmm, bw, obs.part (istart, iend)); // get new betas
+			HMMBaumWelch_getGamma (bw);
+			HMM_HMMBaumWelch_getXi (hmm, bw, obs.part (istart, iend));
+			HMM_HMMBaumWelch_addEstimate (hmm, bw, obs.part (istart, iend));
+			istart = iend + 1;
+		}
+	}
+	MelderThread_RETURN;
+}
+
 void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee, double delta_lnp, double minProb, int info) {
 	try {
 		if (my notHidden) {
@@ -923,6 +999,17 @@ void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee
 		integer capacity = HMMObservationSequenceBag_getLongestSequence (thee);
 		autoHMMBaumWelch bw = HMMBaumWelch_create (my numberOfStates, my numberOfObservationSymbols, capacity);
 		bw -> minProb = minProb;
+
+		// the symbols of the sequences do not change during learning
+		std::vector <autoStringsIndex> indices ((size_t) thy size);
+		for (integer iseq = 1; iseq <= thy size; iseq ++)
+			indices [(size_t) iseq - 1] = HMM_HMMObservationSequence_to_StringsIndex (me, thy at [iseq]);
+
+		const int numberOfThreads = std::max (1, (int) std::min ((integer) MelderThread_getNumberOfProcessors (), thy size));
+		std::vector <autoHMMBaumWelch> threadBaumWelch ((size_t) numberOfThreads);
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++)
+			threadBaumWelch [(size_t) ithread - 1] = HMMBaumWelch_create (my numberOfStates, my numberOfObservationSymbols, capacity);
+
 		if (info)
 			MelderInfo_open (); 
 		integer iter = 0;
@@ -930,34 +1017,23 @@ void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee
 		do {
 			lnp = bw -> lnProb;
 			HMMBaumWelch_reInit (bw.get());
-			for (integer iseq = 1; iseq <= thy size; iseq ++) {
-				HMMObservationSequence hmm_os = thy at [iseq];
-				autoStringsIndex si = HMM_HMMObservationSequence_to_StringsIndex (me, hmm_os); // TODO outside the loop or more efficiently
-				INTVEC obs = si -> classIndex.get();
-				integer nobs = si -> numberOfItems; // convenience
-
-				// Interpretation of unknowns: end of sequence
-
-				integer istart = 1, iend = nobs;
-				while (istart <= nobs) {
-					while (istart <= nobs && obs [istart] == 0)
-						istart ++;
-					if (istart > nobs) break;
-
-					iend = istart + 1;
-					while (iend <= nobs && obs [iend] != 0)
-						iend ++;
-					iend --;
-					bw -> numberOfTimes = iend - istart + 1;
-					bw -> totalNumberOfSequences ++;
-					HMM_HMMBaumWelch_forward (me, bw.get(), obs.part (istart, nobs)); // get new alphas
-					HMM_HMMBaumWelch_backward (me, bw.get(), obs.part (istart, nobs)); // get new betas
-					HMMBaumWelch_getGamma (bw.get());
-					HMM_HMMBaumWelch_getXi (me, bw.get(), obs.part (istart, nobs));
-					HMM_HMMBaumWelch_addEstimate (me, bw.get(), obs.part (istart, nobs));
-					istart = iend + 1;
-				}
+			std::vector <autoHMM_learn_Args> args ((size_t) numberOfThreads);
+			for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+				HMMBaumWelch threadbw = threadBaumWelch [(size_t) ithread - 1].get();
+				HMMBaumWelch_reInit (threadbw);
+				HMM_HMMBaumWelch_cacheProbabilities (me, threadbw);
+				autoHMM_learn_Args arg = Thing_new (HMM_learn_Args);
+				arg -> hmm = me;
+				arg -> indices = & indices;
+				arg -> firstSequence = 1 + (ithread - 1) * thy size / numberOfThreads;
+				arg -> lastSequence = ithread * thy size / numberOfThreads;
+				arg -> bw = threadbw;
+				args [(size_t) ithread - 1] = arg.move();
 			}
+			MelderThread_run (HMM_learn_sequences, args.data(), numberOfThreads);
+			for (int ithread = 1; ithread <= numberOfThreads; ithread ++)
+				HMMBaumWelch_addEstimates (bw.get(), threadBaumWelch [(size_t) ithread - 1].get());
+
 			// we have processed all observation sequences, now it is time to estimate new probabilities.
 			iter ++;
 			HMM_HMMBaumWelch_reestimate (me, bw.get());
@@ -1181,17 +1257,21 @@ void HMM_drawForwardAndBackwardProbabilitiesIllustration (Graphics g, bool garni
 
 void HMM_HMMBaumWelch_getXi (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 	Melder_assert (obs.size == thy numberOfTimes);
+	/*
+		Only the sum over the times is needed for the reestimation,
+		so the xi's of the individual times are not stored.
+	*/
+	thy xi.all() <<= 0.0;
+	const VEC betaEmission = thy betaEmission.get(), transitionSum = thy transitionSum.get();
 	for (integer it = 1; it <= thy numberOfTimes - 1; it ++) {
-		double sum = 0.0;
-		MATVU xi_it = thy xi [it];
+		betaEmission <<= thy beta.row (it + 1)  *  thy emissionsTransposed.row (obs [it + 1]);
+		VECmul_preallocated (transitionSum, thy transitions.get(), betaEmission);
+		const double sum = NUMinner (thy alpha.row (it), transitionSum);
 		for (integer is = 1; is <= thy numberOfStates; is ++) {
-			for (integer js = 1; js <= thy numberOfStates; js ++) {
-				xi_it [is] [js] = thy alpha [is] [it] * thy beta [js] [it + 1] *
-					my transitionProbs [is] [js] * my emissionProbs [js] [ obs [it + 1] ];
-				sum += xi_it [is] [js];
-			}
+			const double alphaDividedBySum = thy alpha [it] [is] / sum;
+			for (integer js = 1; js <= thy numberOfStates; js ++)
+				thy xi [is] [js] += alphaDividedBySum * thy transitions [is] [js] * betaEmission [js];
 		}
-		xi_it /= sum;
 	}
 }
 
@@ -1200,22 +1280,20 @@ void HMM_HMMBaumWelch_addEstimate (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 	for (integer is = 1; is <= my numberOfStates; is ++) {
 		// only for valid start states with p > 0
 		if (my initialStateProbs [is] > 0.0) {
-			thy aij_num_p0 [is] += thy gamma [is] [1];
+			thy aij_num_p0 [is] += thy gamma [1] [is];
 			thy aij_denom_p0 [is] += 1.0;
 		}
 	}
 
 	for (integer is = 1; is <= my numberOfStates; is ++) {
-		double gammasum = NUMsum (thy gamma.row (is).part (1, thy numberOfTimes - 1));
+		double gammasum = 0.0;
+		for (integer it = 1; it <= thy numberOfTimes - 1; it ++)
+			gammasum += thy gamma [it] [is];
 
 		for (integer js = 1; js <= my numberOfStates; js ++) {
-			double xisum = 0.0;
-			for (integer it = 1; it <= thy numberOfTimes - 1; it ++) {
-				xisum += thy xi [it] [is] [js];
-			}
 			// zero probs signal invalid connections, don't reestimate
 			if (my transitionProbs [is] [js] > 0.0) {
-				thy aij_num [is] [js] += xisum;
+				thy aij_num [is] [js] += thy xi [is] [js];
 				thy aij_denom [is] [js] += gammasum;
 			}
 		}
@@ -1225,12 +1303,12 @@ void HMM_HMMBaumWelch_addEstimate (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 			A not hidden model is emulated with fixed emissionProbs.
 		*/
 		if (! my notHidden) {
-			gammasum += thy gamma [is] [thy numberOfTimes];   // now sum all, add last term
+			gammasum += thy gamma [thy numberOfTimes] [is];   // now sum all, add last term
 			for (integer k = 1; k <= my numberOfObservationSymbols; k ++) {
 				double gammasum_k = 0.0;
 				for (integer it = 1; it <= thy numberOfTimes; it ++) {
 					if (obs [it] == k) {
-						gammasum_k += thy gamma [is] [it];
+						gammasum_k += thy gamma [it] [is];
 					}
 				}
 				// only reestimate probs > 0 !
@@ -1242,7 +1320,7 @@ void HMM_HMMBaumWelch_addEstimate (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 		}
 		// For a left-to-right model the final state determines the transition prob to go to the END state
 		if (my leftToRight) {
-			thy aij_num [is] [my numberOfStates + 1] += thy gamma [is] [thy numberOfTimes];
+			thy aij_num [is] [my numberOfStates + 1] += thy gamma [thy numberOfTimes] [is];
 			thy aij_denom [is] [my numberOfStates + 1] += 1.0;
 		}
 	}
@@ -1291,27 +1369,17 @@ void HMM_HMMBaumWelch_reestimate (HMM me, HMMBaumWelch thee) {
 }
 
 void HMM_HMMBaumWelch_forward (HMM me, HMMBaumWelch thee, constINTVEC obs) {
+	Melder_assert (obs.size == thy numberOfTimes);
 	// initialise at t = 1 & scale
-	for (integer js = 1; js <= my numberOfStates; js ++)
-		thy alpha [js] [1] = my initialStateProbs [js] * my emissionProbs [js] [obs [1]];
-	thy scale [1] = NUMsum (thy alpha.column (1));
-	thy alpha.column (1) /= thy scale [1];
-	// recursion
+	thy alpha.row (1) <<= my initialStateProbs.all()  *  thy emissionsTransposed.row (obs [1]);
+	thy scale [1] = NUMsum (thy alpha.row (1));
+	thy alpha.row (1)  /=  thy scale [1];
+	// recursion: alpha (t) = A' alpha (t - 1) * b (obs (t))
 	for (integer it = 2; it <= thy numberOfTimes; it ++) {
-		thy scale [it] = 0.0;
-		for (integer js = 1; js <= my numberOfStates; js ++) {
-			double sum = 0.0;
-			for (integer is = 1; is <= my numberOfStates; is ++) {
-				sum += thy alpha [is] [it - 1] * my transitionProbs [is] [js];
-			}
-
-			thy alpha [js] [it] = sum * my emissionProbs [js] [obs [it]];
-			thy scale [it] += thy alpha [js] [it];
-		}
-
-		for (integer js = 1; js <= my numberOfStates; js ++) {
-			thy alpha [js] [it] /= thy scale [it];
-		}
+		VECmul_preallocated (thy alpha.row (it), thy transitionsTransposed.get(), thy alpha.row (it - 1));
+		thy alpha.row (it)  *=  thy emissionsTransposed.row (obs [it]);
+		thy scale [it] = NUMsum (thy alpha.row (it));
+		thy alpha.row (it)  /=  thy scale [it];
 	}
 
 	for (integer it = 1; it <= thy numberOfTimes; it ++) {
@@ -1321,17 +1389,13 @@ void HMM_HMMBaumWelch_forward (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 
 void HMM_HMMBaumWelch_backward (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 	Melder_assert (obs.size == thy numberOfTimes);
-	for (integer is = 1; is <= my numberOfStates; is ++) {
-		thy beta [is] [thy numberOfTimes] = 1.0 / thy scale [thy numberOfTimes];
-	}
+	thy beta.row (thy numberOfTimes) <<= 1.0 / thy scale [thy numberOfTimes];
+	// recursion: beta (t) = A (b (obs (t + 1)) * beta (t + 1))
+	const VEC betaEmission = thy betaEmission.get();
 	for (integer it = thy numberOfTimes - 1; it >= 1; it --) {
-		for (integer is = 1; is <= my numberOfStates; is ++) {
-			longdouble sum = 0.0;
-			for (integer js = 1; js <= my numberOfStates; js ++) {
-				sum += thy beta [js] [it + 1] * my transitionProbs [is] [js] * my emissionProbs [js] [obs [it + 1]];
-			}
-			thy beta [is] [it] = sum / thy scale [it];
-		}
+		betaEmission <<= thy beta.row (it + 1)  *  thy emissionsTransposed.row (obs [it + 1]);
+		VECmul_preallocated (thy beta.row (it), thy transitions.get(), betaEmission);
+		thy beta.row (it)  /=  thy scale [it];
 	}
 }
 
@@ -1341,34 +1405,44 @@ void HMM_HMMBaumWelch_backward (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 void HMM_HMMViterbi_decode (HMM me, HMMViterbi thee, constINTVEC obs) {
 	Melder_assert (obs.size == thy numberOfTimes);
 	integer numberOfTimes = thy numberOfTimes;
+	/*
+		The products of probabilities underflow for long sequences, so we work with ln(p);
+		p = 0 gives -INFINITY, which can never be the maximum score unless all scores are.
+	*/
+	autoMAT lnTransitionProbs = newMATraw (my numberOfStates, my numberOfStates);
+	for (integer isp = 1; isp <= my numberOfStates; isp ++)
+		for (integer is = 1; is <= my numberOfStates; is ++)
+			lnTransitionProbs [isp] [is] = log (my transitionProbs [isp] [is]);
 	// initialisation
 	for (integer is = 1; is <= my numberOfStates; is ++) {
-		thy viterbi [is] [1] = my initialStateProbs [is] * my emissionProbs [is] [obs [1]];
+		thy viterbi [is] [1] = log (my initialStateProbs [is]) + log (my emissionProbs [is] [obs [1]]);
 		thy bp [is] [1] = 0;
 	}
 	// recursion
 	for (integer it = 2; it <= numberOfTimes; it ++) {
 		for (integer is = 1; is <= my numberOfStates; is ++) {
 			// all transitions isp -> is from previous time to current
-			double max_score = -1; // any negative number is ok
-			for (integer isp = 1; isp <= my numberOfStates; isp ++) {
-				double score = thy viterbi [isp] [it - 1] * my transitionProbs [isp] [is]; // * my emissionProbs [is] [obs [it]]
+			double max_score = thy viterbi [1] [it - 1] + lnTransitionProbs [1] [is];
+			thy bp [is] [it] = 1;
+			for (integer isp = 2; isp <= my numberOfStates; isp ++) {
+				double score = thy viterbi [isp] [it - 1] + lnTransitionProbs [isp] [is]; // + ln (my emissionProbs [is] [obs [it]])
 				if (score > max_score) {
 					max_score = score;
 					thy bp [is] [it] = isp;
 				}
 			}
-			thy viterbi [is] [it] = max_score * my emissionProbs [is] [ obs [it] ];
+			thy viterbi [is] [it] = max_score + log (my emissionProbs [is] [ obs [it] ]);
 		}
 	}
 	// path starts at state with best end probability
 	thy path [numberOfTimes] = 1;
-	thy prob = thy viterbi [1] [numberOfTimes];
+	double lnp = thy viterbi [1] [numberOfTimes];
 	for (integer is = 2; is <= my numberOfStates; is ++) {
-		if (thy viterbi [is] [numberOfTimes] > thy prob) {
-			thy prob = thy viterbi [thy path [numberOfTimes] = is] [numberOfTimes];
+		if (thy viterbi [is] [numberOfTimes] > lnp) {
+			lnp = thy viterbi [thy path [numberOfTimes] = is] [numberOfTimes];
 		}
 	}
+	thy lnProb = lnp;   // exp (lnp) underflows for long sequences
 	// trace back and get path
 	for (integer it = numberOfTimes; it > 1; it --) {
 		thy path [it - 1] = thy bp [thy path [it]] [it];
@@ -50,11 +50,13 @@ Thing_define (HMMBaumWelch, Daata) {
 	integer numberOfSymbols;
 	double lnProb;
 	double minProb;
-	autoMAT alpha;
-	autoMAT beta;
+	autoMAT alpha;   // [time] [state]
+	autoMAT beta;   // [time] [state]
 	autoVEC scale;
-	autoMAT gamma;
-	autoTEN3 xi;
+	autoMAT gamma;   // [time] [state]
+	autoMAT xi;   // [state] [state], summed over the times of one sequence
+	autoMAT transitions, transitionsTransposed, emissionsTransposed;   // contiguous copies of the HMM's probabilities
+	autoVEC betaEmission, transitionSum;   // [state], scratch for the backward pass and for xi
 	autoVEC aij_num_p0;
 	autoMAT aij_num;
 	autoVEC aij_denom_p0;
@@ -78,10 +78,18 @@ oo_DEFINE_CLASS (HMMViterbi, Daata)
 
 	oo_INTEGER (numberOfTimes)
 	oo_INTEGER (numberOfStates)
-	oo_DOUBLE (prob)
-	oo_MAT (viterbi, numberOfStates, numberOfTimes)
+	oo_DOUBLE (lnProb)   // version 0: the probability itself
+	oo_MAT (viterbi, numberOfStates, numberOfTimes)   // ln (probability); version 0: probability
 	oo_INTMAT (bp, numberOfStates, numberOfTimes)
 	oo_INTVEC (path, numberOfTimes)
+	#if oo_READING
+		oo_VERSION_UNTIL (1)
+			our lnProb = log (our lnProb);
+			for (integer is = 1; is <= our numberOfStates; is ++)
+				for (integer it = 1; it <= our numberOfTimes; it ++)
+					our viterbi [is] [it] = log (our viterbi [is] [it]);
+		oo_VERSION_END
+	#endif
 
 oo_END_CLASS (HMMViterbi)
 #undef ooSTRUCT
@@ -291,6 +291,7 @@ static int synthCallback (short *wav, int numsamples, espeak_EVENT *events)
 
 conststring32 SpeechSynthesizer_getLanguageCode (SpeechSynthesizer me) {
 	try {
+		espeakdata_praat_init ();
 		integer irow = Table_searchColumn (espeakdata_languages_propertiesTable.get(), 2, my d_languageName.get());
 		if (irow == 0) {
 			Melder_throw (U"Cannot find language \"", my d_languageName.get(), U"\".");
@@ -303,6 +304,7 @@ conststring32 SpeechSynthesizer_getLanguageCode (SpeechSynthesizer me) {
 
 conststring32 SpeechSynthesizer_getPhonemeCode (SpeechSynthesizer me) {
 	try {
+		espeakdata_praat_init ();
 		integer irow = Table_searchColumn (espeakdata_languages_propertiesTable.get(), 2, my d_phonemeSet.get());
 		if (irow == 0) {
 			Melder_throw (U"Cannot find phoneme set \"", my d_phonemeSet.get(), U"\".");
@@ -315,6 +317,7 @@ conststring32 SpeechSynthesizer_getPhonemeCode (SpeechSynthesizer me) {
 
 conststring32 SpeechSynthesizer_getVoiceCode (SpeechSynthesizer me) {
 	try {
+		espeakdata_praat_init ();
 		integer irow = Table_searchColumn (espeakdata_voices_propertiesTable.get(), 2, my d_voiceName.get());
 		if (irow == 0) {
 			Melder_throw (U": Cannot find voice variant \"", my d_voiceName.get(), U"\".");
@@ -663,6 +666,7 @@ static void espeakdata_SetVoiceByName (conststring32 languageName, conststring32
 
 autoSound SpeechSynthesizer_to_Sound (SpeechSynthesizer me, conststring32 text, autoTextGrid *tg, autoTable *events) {
 	try {
+		espeakdata_praat_init ();   // espeak_ng_Initialize already reads the data, e.g. for a SpeechSynthesizer read from a file
 		espeak_ng_InitializePath (nullptr); // PATH_ESPEAK_DATA
 		espeak_ng_ERROR_CONTEXT context = { 0 };
 		espeak_ng_STATUS status = espeak_ng_Initialize (& context);
@@ -1064,7 +1064,7 @@ integer TableOfReal_getNumberOfLabelMatches (TableOfReal me, conststring32 searc
 		labels = my columnLabels.peek2();
 	}
 	if (use_regexp) {
-		compiled_regexp = CompileRE_throwable (search, 0);
+		compiled_regexp = CompileRE_cached (search, 0);
 	}
 	for (integer i = 1; i <= numberOfLabels; i ++) {
 		if (! labels [i]) {
@@ -1078,8 +1078,6 @@ integer TableOfReal_getNumberOfLabelMatches (TableOfReal me, conststring32 searc
 			nmatches ++;
 		}
 	}
-	if (use_regexp)
-		free (compiled_regexp);   // LEAK if ExecRE throws
 	return nmatches;
 }
 
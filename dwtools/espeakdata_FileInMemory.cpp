@@ -51,6 +51,8 @@ integer Table_getRownumberOfStringInColumn (Table me, conststring32 string, inte
 }
 
 void espeakdata_praat_init () {
+	if (espeak_ng_FileInMemoryManager)
+		return;   // already initialized
 	try {
 		espeak_ng_FileInMemoryManager = create_espeak_ng_FileInMemoryManager ();
 		espeakdata_languages_propertiesTable = Table_createAsEspeakLanguagesProperties ();
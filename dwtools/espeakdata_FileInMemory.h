@@ -36,6 +36,8 @@ void espeakdata_praat_init ();
 /*
 	Creates the FileInMemoryManager espeak_ng_FileInMemoryManager ;
 	Creates Strings espeakdata_languages_names & espeakdata_voices_names
+	Does nothing if these already exist, so call this before the first use of any of them,
+	instead of at start-up, which most sessions would pay for in vain.
 */
 
 autoTable Table_createAsEspeakLanguagesProperties ();
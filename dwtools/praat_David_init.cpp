@@ -463,6 +463,23 @@ DO
 	CONVERT_COUPLE_END (my name.get(), U"_", your name.get());
 }
 
+FORM (NEW1_CCs_to_Table_DTWDistances, U"CCs: To Table (DTW distances)", nullptr) {
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.05")
+	RADIO (slopeConstraint, U"Slope constraint", 1)
+		RADIOBUTTON (U"no restriction")
+		RADIOBUTTON (U"1/3 < slope < 3")
+		RADIOBUTTON (U"1/2 < slope < 2")
+		RADIOBUTTON (U"2/3 < slope < 3/2")
+	RADIO (frameDistance, U"Frame distance", 1)
+		RADIOBUTTON (U"Euclidean")
+		RADIOBUTTON (U"cosine")
+	OK
+DO
+	CONVERT_LIST (CC)
+		autoTable result = CCs_to_Table_DTWDistances (& list, sakoeChibaBand, slopeConstraint, frameDistance);
+	CONVERT_LIST_END (U"dtwDistances")
+}
+
 DIRECT (NEW_CC_to_Matrix) {
 	CONVERT_EACH (CC)
 		autoMatrix result = CC_to_Matrix (me);
@@ -2499,6 +2516,7 @@ DO
 
 DIRECT (NEW1_FileInMemoryManager_create) {
 	CREATE_ONE
+		espeakdata_praat_init ();
 		autoFileInMemoryManager result = Data_copy (espeak_ng_FileInMemoryManager.get());
 	CREATE_ONE_END (U"filesInMemory")
 }
@@ -3626,6 +3644,38 @@ DO
 	CONVERT_COUPLE_END (my name.get(), U"_", your name.get())
 }
 
+FORM (REAL_Matrices_getDTWDistance, U"Matrices: Get DTW distance", nullptr) {
+	REAL (distanceMetric, U"Distance metric", U"2.0")
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.05")
+	RADIO (slopeConstraint, U"Slope constraint", 1)
+		RADIOBUTTON (U"no restriction")
+		RADIOBUTTON (U"1/3 < slope < 3")
+		RADIOBUTTON (U"1/2 < slope < 2")
+		RADIOBUTTON (U"2/3 < slope < 3/2")
+	OK
+DO
+	NUMBER_COUPLE (Matrix)
+		double result = Matrices_getDTWDistance (me, you, sakoeChibaBand, slopeConstraint, distanceMetric);
+	NUMBER_COUPLE_END (U" (weighted distance)")
+}
+
+FORM (NEW1_Matrices_to_Table_DTWDistances, U"Matrices: To Table (DTW distances)", nullptr) {
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.05")
+	RADIO (slopeConstraint, U"Slope constraint", 1)
+		RADIOBUTTON (U"no restriction")
+		RADIOBUTTON (U"1/3 < slope < 3")
+		RADIOBUTTON (U"1/2 < slope < 2")
+		RADIOBUTTON (U"2/3 < slope < 3/2")
+	RADIO (frameDistance, U"Frame distance", 1)
+		RADIOBUTTON (U"Euclidean")
+		RADIOBUTTON (U"cosine")
+	OK
+DO
+	CONVERT_LIST (Matrix)
+		autoTable result = Matrices_to_Table_DTWDistances (& list, sakoeChibaBand, slopeConstraint, frameDistance);
+	CONVERT_LIST_END (U"dtwDistances")
+}
+
 FORM (NEW_Matrix_to_PatternList, U"Matrix: To PatternList", nullptr) {
 	NATURAL (join, U"Join", U"1")
 	OK
@@ -5643,6 +5693,20 @@ END }
 
 /************ Spectrograms *********************************************/
 
+FORM (REAL_Spectrograms_getDTWDistance, U"Spectrograms: Get DTW distance", nullptr) {
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.05")
+	RADIO (slopeConstraint, U"Slope constraint", 1)
+		RADIOBUTTON (U"no restriction")
+		RADIOBUTTON (U"1/3 < slope < 3")
+		RADIOBUTTON (U"1/2 < slope < 2")
+		RADIOBUTTON (U"2/3 < slope < 3/2")
+	OK
+DO
+	NUMBER_COUPLE (Spectrogram)
+		double result = Spectrograms_getDTWDistance (me, you, sakoeChibaBand, slopeConstraint, 1.0);
+	NUMBER_COUPLE_END (U" (weighted distance)")
+}
+
 FORM (NEW1_Spectrograms_to_DTW, U"Spectrograms: To DTW", nullptr) {
 	DTW_constraints_addCommonFields (matchStart, matchEnd, slopeConstraint)
 	OK
@@ -5766,6 +5830,7 @@ FORM (NEW1_ExtractEspeakData, U"SpeechSynthesizer: Extract espeak data", nullptr
 	OK
 DO
 	CREATE_ONE
+		espeakdata_praat_init ();
 		autoTable result;
 		conststring32 name = U"languages";
 		if (which == 1) {
@@ -5778,6 +5843,7 @@ DO
 }
 
 FORM (NEW1_SpeechSynthesizer_create, U"Create SpeechSynthesizer", U"Create SpeechSynthesizer...") {
+	espeakdata_praat_init ();
 	OPTIONMENUSTR (language_string, U"Language", (int) Strings_findString (espeakdata_languages_names.get(), U"English (Great Britain)"))
 	for (integer i = 1; i <= espeakdata_languages_names -> numberOfStrings; i ++) {
 		OPTION (espeakdata_languages_names -> strings [i].get());
@@ -5799,6 +5865,7 @@ DO
 }
 
 FORM (MODIFY_SpeechSynthesizer_modifyPhonemeSet, U"SpeechSynthesizer: Modify phoneme set", nullptr) {
+	espeakdata_praat_init ();
 	OPTIONMENU (phoneneSetIndex, U"Language", (int) Strings_findString (espeakdata_languages_names.get(), U"English (Great Britain)"))
 	for (integer i = 1; i <= espeakdata_languages_names -> numberOfStrings; i ++) {
 			OPTION (espeakdata_languages_names -> strings [i].get());
@@ -7412,6 +7479,7 @@ void praat_CC_init (ClassInfo klas) {
 	praat_addAction1 (klas, 1, U"Get value...", nullptr, praat_HIDDEN + praat_DEPTH_1, REAL_CC_getValue);
 	praat_addAction1 (klas, 0, U"To Matrix", nullptr, 0, NEW_CC_to_Matrix);
 	praat_addAction1 (klas, 2, U"To DTW...", nullptr, 0, NEW1_CCs_to_DTW);
+	praat_addAction1 (klas, 0, U"To Table (DTW distances)...", nullptr, 0, NEW1_CCs_to_Table_DTWDistances);
 }
 
 static void praat_Eigen_Matrix_project (ClassInfo klase, ClassInfo klasm); // deprecated 2014
@@ -7644,8 +7712,6 @@ void praat_uvafon_David_init () {
 
 	VowelEditor_prefs ();
 
-	espeakdata_praat_init ();
-
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report floating point properties", U"Report integer properties", 0, INFO_Praat_ReportFloatingPointProperties);
 	praat_addMenuCommand (U"Objects", U"Goodies", U"Get TukeyQ...", 0, praat_HIDDEN, REAL_Praat_getTukeyQ);
 	praat_addMenuCommand (U"Objects", U"Goodies", U"Get invTukeyQ...", 0, praat_HIDDEN, REAL_Praat_getInvTukeyQ);
@@ -8120,6 +8186,8 @@ void praat_uvafon_David_init () {
 	praat_addAction1 (classMatrix, 0, U"To Eigen", U"Eigen", praat_HIDDEN, NEW_Matrix_to_Eigen);
 	praat_addAction1 (classMatrix, 0, U"Eigen (complex)", U"Eigen", praat_HIDDEN, NEWTIMES2_Matrix_eigen_complex);
 	praat_addAction1 (classMatrix, 2, U"To DTW...", U"To ParamCurve", 1, NEW1_Matrices_to_DTW);
+	praat_addAction1 (classMatrix, 2, U"Get DTW distance...", U"To DTW...", 1, REAL_Matrices_getDTWDistance);
+	praat_addAction1 (classMatrix, 0, U"To Table (DTW distances)...", U"Get DTW distance...", 1, NEW1_Matrices_to_Table_DTWDistances);
 
 	praat_addAction2 (classMatrix, 1, classCategories, 1, U"To TableOfReal", nullptr, 0, NEW1_Matrix_Categories_to_TableOfReal);
 
@@ -8343,6 +8411,7 @@ void praat_uvafon_David_init () {
 	praat_addAction2 (classSound, 1, classIntervalTier, 1, U"Cut parts matching label...", nullptr, 0, NEW1_Sound_IntervalTier_cutPartsMatchingLabel);
 
 	praat_addAction1 (classSpectrogram, 2, U"To DTW...", U"To Spectrum (slice)...", 1, NEW1_Spectrograms_to_DTW);
+	praat_addAction1 (classSpectrogram, 2, U"Get DTW distance...", U"To DTW...", 1, REAL_Spectrograms_getDTWDistance);
 
 	praat_addAction1 (classSpectrum, 0, U"Draw phases...", U"Draw (log freq)...", praat_DEPTH_1 | praat_HIDDEN, GRAPHICS_Spectrum_drawPhases);
 	praat_addAction1 (classSpectrum, 0, U"Set real value in bin...", U"Formula...", praat_HIDDEN | praat_DEPTH_1, MODIFY_Spectrum_setRealValueInBin);
@@ -27,7 +27,16 @@
 #include <errno.h>
 
 extern autoFileInMemoryManager espeak_ng_FileInMemoryManager;
-#define ESPEAK_FILEINMEMORYMANAGER espeak_ng_FileInMemoryManager.get()
+
+/*
+	The espeak data are created on first use (see espeakdata_praat_init),
+	so every entry point makes sure that they exist before it touches them.
+*/
+static FileInMemoryManager espeak_io_getFileInMemoryManager () {
+	espeakdata_praat_init ();
+	return espeak_ng_FileInMemoryManager.get();
+}
+#define ESPEAK_FILEINMEMORYMANAGER espeak_io_getFileInMemoryManager ()
 
 FILE *espeak_io_fopen (const char * filename, const char * mode) {
 	return FileInMemoryManager_fopen (ESPEAK_FILEINMEMORYMANAGER, filename, mode);
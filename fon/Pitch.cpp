@@ -500,8 +500,10 @@ void Pitch_pathFinder (Pitch me, double silenceThreshold, double voicingThreshol
 			U"\nPull formants = ", pullFormants);
 	try {
 		integer maxnCandidates = Pitch_getMaxnCandidates (me);
+		Melder_require (maxnCandidates <= INT16_MAX,
+			U"The number of candidates should not exceed ", INT16_MAX, U".");
 		integer place;
-		volatile double maximum, value;
+		double maximum;
 		double ceiling2 = pullFormants ? 2.0 * ceiling : ceiling;
 		/* Next three lines 20011015 */
 		double timeStepCorrection = 0.01 / my dx;
@@ -510,7 +512,8 @@ void Pitch_pathFinder (Pitch me, double silenceThreshold, double voicingThreshol
 
 		my ceiling = ceiling;
 		autoMAT delta = newMATzero (my nx, maxnCandidates);
-		autoINTMAT psi = newINTMATzero (my nx, maxnCandidates);
+		automatrix <int16> psi = newmatrixzero <int16> (my nx, maxnCandidates);
+		autoBOOLMAT voiced = newBOOLMATzero (my nx, maxnCandidates);
 
 		for (integer iframe = 1; iframe <= my nx; iframe ++) {
 			Pitch_Frame frame = & my frame [iframe];
@@ -519,8 +522,8 @@ void Pitch_pathFinder (Pitch me, double silenceThreshold, double voicingThreshol
 			unvoicedStrength = voicingThreshold + (unvoicedStrength > 0.0 ? unvoicedStrength : 0.0);
 			for (integer icand = 1; icand <= frame -> nCandidates; icand ++) {
 				Pitch_Candidate candidate = & frame -> candidate [icand];
-				bool voiceless = ! Pitch_util_frequencyIsVoiced (candidate -> frequency, ceiling2);
-				delta [iframe] [icand] = voiceless ? unvoicedStrength :
+				voiced [iframe] [icand] = Pitch_util_frequencyIsVoiced (candidate -> frequency, ceiling2);
+				delta [iframe] [icand] = ! voiced [iframe] [icand] ? unvoicedStrength :
 					candidate -> strength - octaveCost * NUMlog2 (ceiling / candidate -> frequency);
 			}
 		}
@@ -529,51 +532,54 @@ void Pitch_pathFinder (Pitch me, double silenceThreshold, double voicingThreshol
 		/* There is a cost for the voiced/unvoiced transition, */
 		/* and a cost for a frequency jump. */
 
+		/*
+			The transition costs from all previous candidates to one current candidate
+			are collected in a contiguous vector first, so that the search for the maximum is a simple loop.
+			The frequency jump cost is computed as log2 (f1 / f2) rather than as the difference of cached
+			logarithms, because the latter can differ in the last bit and would break ties differently.
+		*/
+		autoVEC previousFrequency = newVECzero (maxnCandidates), transitionCost = newVECzero (maxnCandidates);
 		for (integer iframe = 2; iframe <= my nx; iframe ++) {
 			Pitch_Frame prevFrame = & my frame [iframe - 1], curFrame = & my frame [iframe];
+			const integer numberOfPreviousCandidates = prevFrame -> nCandidates;
 			constVEC prevDelta = delta [iframe - 1];
+			constBOOLVEC previousVoiced = voiced [iframe - 1];
 			VEC curDelta = delta [iframe];
-			INTVEC curPsi = psi [iframe];
+			for (integer icand1 = 1; icand1 <= numberOfPreviousCandidates; icand1 ++)
+				previousFrequency [icand1] = prevFrame -> candidate [icand1]. frequency;
 			for (integer icand2 = 1; icand2 <= curFrame -> nCandidates; icand2 ++) {
-				double f2 = curFrame -> candidate [icand2]. frequency;
-				maximum = -1e30;
-				place = 0;
-				for (integer icand1 = 1; icand1 <= prevFrame -> nCandidates; icand1 ++) {
-					double f1 = prevFrame -> candidate [icand1]. frequency;
-					double transitionCost;
-					bool previousVoiceless = ! Pitch_util_frequencyIsVoiced (f1, ceiling2);
-					bool currentVoiceless = ! Pitch_util_frequencyIsVoiced (f2, ceiling2);
-					if (currentVoiceless) {
-						if (previousVoiceless) {
-							transitionCost = 0.0;   // both voiceless
-						} else {
-							transitionCost = voicedUnvoicedCost;   // voiced-to-unvoiced transition
-						}
-					} else {
-						if (previousVoiceless) {
-							transitionCost = voicedUnvoicedCost;   // unvoiced-to-voiced transition
-							if (Melder_debug == 30) {
-								/*
-									Try to take into account a frequency jump across a voiceless stretch.
-								*/
-								integer place1 = icand1;
-								for (integer jframe = iframe - 2; jframe >= 1; jframe --) {
-									place1 = psi [jframe + 1] [place1];
-									f1 = my frame [jframe]. candidate [place1]. frequency;
-									if (Pitch_util_frequencyIsVoiced (f1, ceiling)) {
-										transitionCost += octaveJumpCost * fabs (NUMlog2 (f1 / f2)) / (iframe - jframe);
-										break;
-									}
+				const double f2 = curFrame -> candidate [icand2]. frequency;
+				if (! voiced [iframe] [icand2]) {
+					for (integer icand1 = 1; icand1 <= numberOfPreviousCandidates; icand1 ++)
+						transitionCost [icand1] = ( previousVoiced [icand1] ? voicedUnvoicedCost : 0.0 );   // voiced-to-unvoiced transition, or both voiceless
+				} else {
+					for (integer icand1 = 1; icand1 <= numberOfPreviousCandidates; icand1 ++)
+						transitionCost [icand1] = ( previousVoiced [icand1] ?
+								octaveJumpCost * fabs (NUMlog2 (previousFrequency [icand1] / f2)) :   // both voiced
+								voicedUnvoicedCost );   // unvoiced-to-voiced transition
+					if (Melder_debug == 30) {
+						for (integer icand1 = 1; icand1 <= numberOfPreviousCandidates; icand1 ++) {
+							if (previousVoiced [icand1])
+								continue;
+							/*
+								Try to take into account a frequency jump across a voiceless stretch.
+							*/
+							integer place1 = icand1;
+							for (integer jframe = iframe - 2; jframe >= 1; jframe --) {
+								place1 = psi [jframe + 1] [place1];
+								double f1 = my frame [jframe]. candidate [place1]. frequency;
+								if (Pitch_util_frequencyIsVoiced (f1, ceiling)) {
+									transitionCost [icand1] += octaveJumpCost * fabs (NUMlog2 (f1 / f2)) / (iframe - jframe);
+									break;
 								}
 							}
-						} else {
-							transitionCost = octaveJumpCost * fabs (NUMlog2 (f1 / f2));   // both voiced
 						}
 					}
-					value = prevDelta [icand1] - transitionCost + curDelta [icand2];
-					//if (Melder_debug == 33) Melder_casual (U"Frame ", iframe, U", current candidate ", icand2,
-					//  U" (delta ", curDelta [icand2], U"), previous candidate ", icand1, U" (delta ", prevDelta [icand1], U"), ",
-					//	U"transition cost ", transitionCost, U", value ", value, U", maximum ", maximum);
+				}
+				maximum = -1e30;
+				place = 0;
+				for (integer icand1 = 1; icand1 <= numberOfPreviousCandidates; icand1 ++) {
+					const double value = prevDelta [icand1] - transitionCost [icand1] + curDelta [icand2];
 					if (value > maximum) {
 						maximum = value;
 						place = icand1;
@@ -587,7 +593,7 @@ void Pitch_pathFinder (Pitch me, double silenceThreshold, double voicingThreshol
 					}
 				}
 				curDelta [icand2] = maximum;
-				curPsi [icand2] = place;
+				psi [iframe] [icand2] = (int16) place;
 			}
 		}
 
@@ -29,6 +29,7 @@
 #include "praat.h"
 #include "NUM2.h"
 #include "Sound.h"
+#include "WaveformPyramid.h"
 
 #include "enums_getText.h"
 #include "Praat_tests_enums.h"
@@ -641,6 +642,11 @@ int Praat_tests (kPraatTests itest, conststring32 arg1, conststring32 arg2, cons
 		case kPraatTests::FILEINMEMORYMANAGER_IO: {
 			test_FileInMemoryManager_io ();
 		} break;
+		case kPraatTests::WAVEFORM_PYRAMID: {
+			structMelderFile file { };
+			Melder_relativePathToFile (arg2, & file);
+			test_WaveformPyramid (& file, n);
+		} break;
 	}
 	MelderInfo_writeLine (Melder_single (n / t * 1e-9), U" Gflop/s");
 	MelderInfo_close ();
@@ -19,23 +19,36 @@
 #include "Sound_to_Pitch.h"
 #include "Sound_to_Harmonicity.h"
 
+static autoHarmonicity Pitch_to_Harmonicity_ (Pitch pitch, double xmin, double xmax) {
+	autoHarmonicity thee = Harmonicity_create (xmin, xmax, pitch -> nx, pitch -> dx, pitch -> x1);
+	for (integer i = 1; i <= thy nx; i ++) {
+		if (pitch -> frame [i]. candidate [1]. frequency == 0.0) {
+			thy z [1] [i] = -200.0;
+		} else {
+			double r = pitch -> frame [i]. candidate [1]. strength;
+			thy z [1] [i] = ( r <= 1e-15 ? -150.0 : r > 1.0 - 1e-15 ? 150.0 : 10.0 * log10 (r / (1.0 - r)) );
+		}
+	}
+	return thee;
+}
+
+autoHarmonicity Pitch_to_Harmonicity (Pitch me, double silenceThreshold) {
+	try {
+		autoPitch pitch = Data_copy (me);
+		Pitch_pathFinder (pitch.get(), silenceThreshold, 0.0, 0.0, 0.0, 0.0, my ceiling, Melder_debug == 31 ? true : false);
+		return Pitch_to_Harmonicity_ (pitch.get(), my xmin, my xmax);
+	} catch (MelderError) {
+		Melder_throw (me, U": not converted to Harmonicity.");
+	}
+}
+
 autoHarmonicity Sound_to_Harmonicity_ac (Sound me, double dt, double minimumPitch,
 	double silenceThreshold, double periodsPerWindow)
 {
 	try {
 		autoPitch pitch = Sound_to_Pitch_any (me, dt, minimumPitch, periodsPerWindow, 15, 1,
 			silenceThreshold, 0.0, 0.0, 0.0, 0.0, 0.5 / my dx);
-		autoHarmonicity thee = Harmonicity_create (my xmin, my xmax, pitch -> nx,
-			pitch -> dx, pitch -> x1);
-		for (integer i = 1; i <= thy nx; i ++) {
-			if (pitch -> frame [i]. candidate [1]. frequency == 0.0) {
-				thy z [1] [i] = -200.0;
-			} else {
-				double r = pitch -> frame [i]. candidate [1]. strength;
-				thy z [1] [i] = ( r <= 1e-15 ? -150.0 : r > 1.0 - 1e-15 ? 150.0 : 10.0 * log10 (r / (1.0 - r)) );
-			}
-		}
-		return thee;
+		return Pitch_to_Harmonicity_ (pitch.get(), my xmin, my xmax);
 	} catch (MelderError) {
 		Melder_throw (me, U": harmonicity analysis (ac) not performed.");
 	}
@@ -47,17 +60,7 @@ autoHarmonicity Sound_to_Harmonicity_cc (Sound me, double dt, double minimumPitc
 	try {
 		autoPitch pitch = Sound_to_Pitch_any (me, dt, minimumPitch, periodsPerWindow, 15, 3,
 			silenceThreshold, 0.0, 0.0, 0.0, 0.0, 0.5 / my dx);
-		autoHarmonicity thee = Harmonicity_create (my xmin, my xmax, pitch -> nx,
-			pitch -> dx, pitch -> x1);
-		for (integer i = 1; i <= thy nx; i ++) {
-			if (pitch -> frame [i]. candidate [1]. frequency == 0.0) {
-				thy z [1] [i] = -200.0;
-			} else {
-				double r = pitch -> frame [i]. candidate [1]. strength;
-				thy z [1] [i] = ( r <= 1e-15 ? -150.0 : r > 1.0 - 1e-15 ? 150.0 : 10.0 * log10 (r / (1.0 - r)) );
-			}
-		}
-		return thee;
+		return Pitch_to_Harmonicity_ (pitch.get(), my xmin, my xmax);
 	} catch (MelderError) {
 		Melder_throw (me, U": harmonicity analysis (cc) not performed.");
 	}
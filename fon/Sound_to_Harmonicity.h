@@ -18,6 +18,7 @@
 
 #include "Sound.h"
 #include "Harmonicity.h"
+#include "Pitch.h"
 
 autoHarmonicity Sound_to_Harmonicity_ac (Sound me, double dt, double minimumPitch,
 	double silenceThreshold, double periodsPerWindow);
@@ -25,6 +26,15 @@ autoHarmonicity Sound_to_Harmonicity_ac (Sound me, double dt, double minimumPitc
 autoHarmonicity Sound_to_Harmonicity_cc (Sound me, double dt, double minimumPitch,
 	double silenceThreshold, double periodsPerWindow);
 
+autoHarmonicity Pitch_to_Harmonicity (Pitch me, double silenceThreshold);
+/*
+	'me' should be a periodicity analysis, i.e. the result of Sound_to_Pitch_candidates,
+	computed with a voicing threshold and an octave cost of 0.0 and a maximum pitch at the Nyquist frequency;
+	'me' is not changed. Sound_to_Harmonicity_ac is Pitch_to_Harmonicity applied to
+	Sound_to_Pitch_candidates (sound, dt, minimumPitch, periodsPerWindow, 15, 1, 0.0, 0.0, nyquistFrequency),
+	and Sound_to_Harmonicity_cc is the same with method 3.
+*/
+
 autoMatrix Sound_to_Harmonicity_GNE (Sound me,
 	double fmin,   /* 500 Hz */
 	double fmax,   /* 4500 Hz */
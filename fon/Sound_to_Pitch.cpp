@@ -343,11 +343,9 @@ static MelderThread_RETURN_TYPE Sound_into_Pitch (Sound_into_Pitch_Args me)
 	MelderThread_RETURN;
 }
 
-autoPitch Sound_to_Pitch_any (Sound me,
+static autoPitch Sound_to_Pitch_candidates_ (Sound me,
 	double dt, double minimumPitch, double periodsPerWindow, int maxnCandidates,
-	int method,
-	double silenceThreshold, double voicingThreshold,
-	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost, double ceiling)
+	int method, double voicingThreshold, double octaveCost, double ceiling)
 {
 	try {
 		autoNUMfft_Table fftTable;
@@ -524,8 +522,6 @@ autoPitch Sound_to_Pitch_any (Sound me,
 			brent_ixmax = Melder_ifloor (nsamp_window * interpolation_depth);
 		}
 
-		autoMelderProgress progress (U"Sound to Pitch...");
-
 		integer numberOfFramesPerThread = 20;
 		int numberOfThreads = (numberOfFrames - 1) / numberOfFramesPerThread + 1;
 		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
@@ -553,10 +549,34 @@ autoPitch Sound_to_Pitch_any (Sound me,
 		}
 		MelderThread_run (Sound_into_Pitch, args, numberOfThreads);
 
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": periodicity analysis not performed.");
+	}
+}
+
+autoPitch Sound_to_Pitch_candidates (Sound me,
+	double dt, double minimumPitch, double periodsPerWindow, int maxnCandidates,
+	int method, double voicingThreshold, double octaveCost, double ceiling)
+{
+	autoMelderProgress progress (U"Sound to Pitch...");
+	return Sound_to_Pitch_candidates_ (me, dt, minimumPitch, periodsPerWindow, maxnCandidates,
+		method, voicingThreshold, octaveCost, ceiling);
+}
+
+autoPitch Sound_to_Pitch_any (Sound me,
+	double dt, double minimumPitch, double periodsPerWindow, int maxnCandidates,
+	int method,
+	double silenceThreshold, double voicingThreshold,
+	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost, double ceiling)
+{
+	try {
+		autoMelderProgress progress (U"Sound to Pitch...");
+		autoPitch thee = Sound_to_Pitch_candidates_ (me, dt, minimumPitch, periodsPerWindow, maxnCandidates,
+			method, voicingThreshold, octaveCost, ceiling);
 		Melder_progress (0.95, U"Sound to Pitch: path finder");
 		Pitch_pathFinder (thee.get(), silenceThreshold, voicingThreshold,
-			octaveCost, octaveJumpCost, voicedUnvoicedCost, ceiling, Melder_debug == 31 ? true : false);
-
+			octaveCost, octaveJumpCost, voicedUnvoicedCost, thy ceiling, Melder_debug == 31 ? true : false);   // the ceiling has been clipped to the Nyquist frequency
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": pitch analysis not performed.");
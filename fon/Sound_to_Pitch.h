@@ -84,4 +84,19 @@ autoPitch Sound_to_Pitch_any (Sound me,
 		pitches above a certain value "voiceless".
 */
 
+autoPitch Sound_to_Pitch_candidates (Sound me,
+	double dt, double minimumPitch, double periodsPerWindow, int maxnCandidates,
+	int method, double voicingThreshold, double octaveCost, double maximumPitch);
+/*
+	Function:
+		the periodicity analysis of Sound_to_Pitch_any, without the path finder.
+	Return value:
+		a Pitch whose frames contain all their candidates in the order in which they were found;
+		candidate 1 is the voiceless candidate.
+	Postcondition:
+		Running Pitch_pathFinder on (a copy of) the result, with the same voicing threshold and octave cost,
+		gives exactly the Pitch that Sound_to_Pitch_any computes. Several Pitch or Harmonicity contours
+		with different path finder settings can therefore share one periodicity analysis.
+*/
+
 /* End of file Sound_to_Pitch.h */
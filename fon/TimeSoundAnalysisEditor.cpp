@@ -126,6 +126,8 @@ void structTimeSoundAnalysisEditor :: v_info () {
 }
 
 void structTimeSoundAnalysisEditor :: v_reset_analysis () {
+	if (d_sound. data)
+		d_sound. pyramid. reset();   // the samples may have changed as well (a LongSound's cannot)
 	d_spectrogram. reset();
 	d_pitch. reset();
 	d_intensity. reset();
@@ -454,6 +454,115 @@ void structTimeSoundEditor :: v_updateMenuItems_file () {
 	GuiThing_setSensitive (our writeFlacButton, selectedSamples != 0);
 }
 
+static integer TimeSoundEditor_getNumberOfPixelsInWindow (TimeSoundEditor me) {
+	double x1NDC, x2NDC, y1NDC, y2NDC, x1wsNDC, x2wsNDC, y1wsNDC, y2wsNDC;
+	integer x1wsDC, x2wsDC, y1wsDC, y2wsDC;
+	Graphics_inqViewport (my graphics.get(), & x1NDC, & x2NDC, & y1NDC, & y2NDC);
+	Graphics_inqWsWindow (my graphics.get(), & x1wsNDC, & x2wsNDC, & y1wsNDC, & y2wsNDC);
+	Graphics_inqWsViewport (my graphics.get(), & x1wsDC, & x2wsDC, & y1wsDC, & y2wsDC);
+	if (x2wsNDC == x1wsNDC)
+		return 1;
+	return Melder_iround (fabs ((x2NDC - x1NDC) / (x2wsNDC - x1wsNDC) * (x2wsDC - x1wsDC))) + 1;
+}
+
+/*
+	With many samples per pixel, we draw the waveform from its min/max pyramid, in a time proportional to the number of pixels.
+	For a Sound, the pyramid is computed the first time this happens.
+	For a LongSound, this requires reading the whole file, so this is done only when a window that does not fit into the buffer
+	has to be drawn, and in steps of a tenth of a second, with a redraw after each step, so that the editor stays responsive;
+	if the user zooms in before the pyramid is complete, reading stops until the window no longer fits again.
+	The complete pyramid is then used for all windows that are wide enough, which therefore no longer have to be read into the buffer.
+*/
+static WaveformPyramid TimeSoundEditor_getPyramid (TimeSoundEditor me, bool windowFitsIntoBuffer) {
+	Sampled sampled = ( my d_sound.data ? (Sampled) my d_sound.data : (Sampled) my d_longSound.data );
+	integer first, last;
+	const integer numberOfSamples = Sampled_getWindowSamples (sampled, my startWindow, my endWindow, & first, & last);
+	const bool isWideEnough = ( numberOfSamples >= 2 * WaveformPyramid_getBlockSize (1) * TimeSoundEditor_getNumberOfPixelsInWindow (me) );
+	if (my d_sound.data) {
+		if (my d_sound.pyramid && my d_sound.pyramid -> numberOfSamples != sampled -> nx)
+			my d_sound.pyramid. reset();
+		if (! my d_sound.pyramid && isWideEnough)
+			my d_sound.pyramid = WaveformPyramid_createFromSound (my d_sound.data);
+	} else if (! windowFitsIntoBuffer) {
+		if (! my d_sound.pyramid)
+			my d_sound.pyramid = WaveformPyramid_createFromLongSound_start (my d_longSound.data);
+		WaveformPyramid_createFromLongSound_step (my d_sound.pyramid.get(), my d_longSound.data, 0.1);
+	}
+	if (! my d_sound.pyramid || ! WaveformPyramid_isComplete (my d_sound.pyramid.get()))
+		return nullptr;
+	const bool isUseful = ( isWideEnough || ! windowFitsIntoBuffer );
+	return isUseful ? my d_sound.pyramid.get() : nullptr;
+}
+
+static void TimeSoundEditor_getSampleExtrema (TimeSoundEditor me, integer first, integer last, integer channel,
+	double *inout_minimum, double *inout_maximum)
+{
+	if (last < first)
+		return;
+	if (my d_sound.data) {
+		constVEC samples = my d_sound.data -> z.row (channel).part (first, last);
+		for (integer i = 1; i <= samples.size; i ++) {
+			if (samples [i] < *inout_minimum)
+				*inout_minimum = samples [i];
+			if (samples [i] > *inout_maximum)
+				*inout_maximum = samples [i];
+		}
+	} else {
+		LongSound longSound = my d_longSound.data;
+		const integer numberOfChannels = longSound -> numberOfChannels, numberOfSamples = last - first + 1;
+		autovector <int16> buffer = newvectorraw <int16> ((numberOfSamples + 1) * numberOfChannels);   // the compressed readers write one sample further
+		LongSound_readAudioToShort (longSound, & buffer [1], first, numberOfSamples);
+		const int16 *samples = & buffer [1 + channel - 1];
+		for (integer i = 0; i < numberOfSamples; i ++) {
+			const double value = samples [i * numberOfChannels] / 32768.0;
+			if (value < *inout_minimum)
+				*inout_minimum = value;
+			if (value > *inout_maximum)
+				*inout_maximum = value;
+		}
+	}
+}
+
+static void TimeSoundEditor_getWindowExtrema (TimeSoundEditor me, WaveformPyramid pyramid, integer first, integer last, integer channel,
+	double *out_minimum, double *out_maximum)
+{
+	if (pyramid) {
+		/*
+			The whole blocks come from the pyramid, the samples at the edges from the sound itself,
+			so that no sample outside the window is taken into account.
+		*/
+		integer firstWhole, lastWhole;
+		WaveformPyramid_getWholeBlocks (pyramid, first, last, & firstWhole, & lastWhole);
+		double minimum = + INFINITY, maximum = - INFINITY;
+		if (lastWhole < firstWhole) {
+			TimeSoundEditor_getSampleExtrema (me, first, last, channel, & minimum, & maximum);
+		} else {
+			WaveformPyramid_getExtrema (pyramid, channel, firstWhole, lastWhole, & minimum, & maximum);
+			TimeSoundEditor_getSampleExtrema (me, first, firstWhole - 1, channel, & minimum, & maximum);
+			TimeSoundEditor_getSampleExtrema (me, lastWhole + 1, last, channel, & minimum, & maximum);
+		}
+		*out_minimum = minimum;
+		*out_maximum = maximum;
+	} else if (my d_longSound.data)
+		LongSound_getWindowExtrema (my d_longSound.data, my startWindow, my endWindow, channel, out_minimum, out_maximum);
+	else
+		Matrix_getWindowExtrema (my d_sound.data, first, last, channel, channel, out_minimum, out_maximum);
+}
+
+static void TimeSoundEditor_drawEnvelope (TimeSoundEditor me, WaveformPyramid pyramid, integer channel, integer first, integer last,
+	double xFirst, double xLast)
+{
+	const integer numberOfColumns = std::min (TimeSoundEditor_getNumberOfPixelsInWindow (me), last - first + 1);
+	autoVEC minimum = newVECraw (numberOfColumns), maximum = newVECraw (numberOfColumns);
+	WaveformPyramid_getEnvelope (pyramid, channel, first, last, minimum.get(), maximum.get());
+	autoVEC envelope = newVECraw (2 * numberOfColumns);
+	for (integer icol = 1; icol <= numberOfColumns; icol ++) {
+		envelope [2 * icol - 1] = minimum [icol];
+		envelope [2 * icol] = maximum [icol];
+	}
+	Graphics_function (my graphics.get(), envelope.at, 1, envelope.size, xFirst, xLast);
+}
+
 void TimeSoundEditor_drawSound (TimeSoundEditor me, double globalMinimum, double globalMaximum) {
 	Sound sound = my d_sound.data;
 	LongSound longSound = my d_longSound.data;
@@ -462,8 +571,19 @@ void TimeSoundEditor_drawSound (TimeSoundEditor me, double globalMinimum, double
 	bool cursorVisible = my startSelection == my endSelection && my startSelection >= my startWindow && my startSelection <= my endWindow;
 	Graphics_setColour (my graphics.get(), Graphics_BLACK);
 	bool fits;
+	WaveformPyramid pyramid = nullptr;
 	try {
-		fits = sound ? true : LongSound_haveWindow (longSound, my startWindow, my endWindow);
+		if (sound) {
+			fits = true;
+			pyramid = TimeSoundEditor_getPyramid (me, true);
+		} else {
+			pyramid = TimeSoundEditor_getPyramid (me, true);   // if wide enough
+			fits = pyramid || LongSound_haveWindow (longSound, my startWindow, my endWindow);
+			if (! fits) {
+				pyramid = TimeSoundEditor_getPyramid (me, false);   // if there
+				fits = !! pyramid;
+			}
+		}
 	} catch (MelderError) {
 		bool outOfMemory = !! str32str (Melder_getError (), U"memory");
 		if (Melder_debug == 9) Melder_flushError (); else Melder_clearError ();
@@ -475,7 +595,16 @@ void TimeSoundEditor_drawSound (TimeSoundEditor me, double globalMinimum, double
 	if (! fits) {
 		Graphics_setWindow (my graphics.get(), 0.0, 1.0, 0.0, 1.0);
 		Graphics_setTextAlignment (my graphics.get(), Graphics_CENTRE, Graphics_HALF);
-		Graphics_text (my graphics.get(), 0.5, 0.5, U"(window too large; zoom in to see the data)");
+		if (my d_sound.pyramid) {
+			/*
+				The pyramid is still being read; ask for another redraw, which will take the next step.
+			*/
+			Graphics_text (my graphics.get(), 0.5, 0.5, U"(reading the waveform: ",
+				Melder_percent ((double) my d_sound.pyramid -> numberOfBlocksRead / my d_sound.pyramid -> minimum [1].ncol, 0), U")");
+			Graphics_updateWs (my graphics.get());
+		} else {
+			Graphics_text (my graphics.get(), 0.5, 0.5, U"(window too large; zoom in to see the data)");
+		}
 		return;
 	}
 	integer first, last;
@@ -490,22 +619,29 @@ void TimeSoundEditor_drawSound (TimeSoundEditor me, double globalMinimum, double
 	integer lastVisibleChannel = my d_sound.channelOffset + numberOfVisibleChannels;
 	if (lastVisibleChannel > numberOfChannels)
 		lastVisibleChannel = numberOfChannels;
+	double windowMinimum [1 + 8], windowMaximum [1 + 8];   // the extrema of each visible channel in the window
+	if (my p_sound_scalingStrategy != kTimeSoundEditor_scalingStrategy::FIXED_RANGE) {
+		try {
+			for (integer ichan = firstVisibleChannel; ichan <= lastVisibleChannel; ichan ++)
+				TimeSoundEditor_getWindowExtrema (me, pyramid, first, last, ichan,
+					& windowMinimum [ichan - firstVisibleChannel + 1], & windowMaximum [ichan - firstVisibleChannel + 1]);
+		} catch (MelderError) {
+			if (Melder_debug == 9) Melder_flushError (); else Melder_clearError ();
+			Graphics_setWindow (my graphics.get(), 0.0, 1.0, 0.0, 1.0);
+			Graphics_setTextAlignment (my graphics.get(), Graphics_CENTRE, Graphics_HALF);
+			Graphics_text (my graphics.get(), 0.5, 0.5, U"(cannot read sound file)");
+			return;
+		}
+	}
 	double maximumExtent = 0.0, visibleMinimum = 0.0, visibleMaximum = 0.0;
 	if (my p_sound_scalingStrategy == kTimeSoundEditor_scalingStrategy::BY_WINDOW) {
-		if (longSound)
-			LongSound_getWindowExtrema (longSound, my startWindow, my endWindow, firstVisibleChannel, & visibleMinimum, & visibleMaximum);
-		else
-			Matrix_getWindowExtrema (sound, first, last, firstVisibleChannel, firstVisibleChannel, & visibleMinimum, & visibleMaximum);
+		visibleMinimum = windowMinimum [1];
+		visibleMaximum = windowMaximum [1];
 		for (integer ichan = firstVisibleChannel + 1; ichan <= lastVisibleChannel; ichan ++) {
-			double visibleChannelMinimum, visibleChannelMaximum;
-			if (longSound)
-				LongSound_getWindowExtrema (longSound, my startWindow, my endWindow, ichan, & visibleChannelMinimum, & visibleChannelMaximum);
-			else
-				Matrix_getWindowExtrema (sound, first, last, ichan, ichan, & visibleChannelMinimum, & visibleChannelMaximum);
-			if (visibleChannelMinimum < visibleMinimum)
-				visibleMinimum = visibleChannelMinimum;
-			if (visibleChannelMaximum > visibleMaximum)
-				visibleMaximum = visibleChannelMaximum;
+			if (windowMinimum [ichan - firstVisibleChannel + 1] < visibleMinimum)
+				visibleMinimum = windowMinimum [ichan - firstVisibleChannel + 1];
+			if (windowMaximum [ichan - firstVisibleChannel + 1] > visibleMaximum)
+				visibleMaximum = windowMaximum [ichan - firstVisibleChannel + 1];
 		}
 		maximumExtent = visibleMaximum - visibleMinimum;
 	}
@@ -522,11 +658,8 @@ void TimeSoundEditor_drawSound (TimeSoundEditor me, double globalMinimum, double
 		double minimum = sound ? globalMinimum : -1.0, maximum = sound ? globalMaximum : 1.0;
 		if (my p_sound_scalingStrategy == kTimeSoundEditor_scalingStrategy::BY_WINDOW) {
 			if (numberOfChannels > 2) {
-				if (longSound) {
-					LongSound_getWindowExtrema (longSound, my startWindow, my endWindow, ichan, & minimum, & maximum);
-				} else {
-					Matrix_getWindowExtrema (sound, first, last, ichan, ichan, & minimum, & maximum);
-				}
+				minimum = windowMinimum [ichan - firstVisibleChannel + 1];
+				maximum = windowMaximum [ichan - firstVisibleChannel + 1];
 				if (maximumExtent > 0.0) {
 					double middle = 0.5 * (minimum + maximum);
 					minimum = middle - 0.5 * maximumExtent;
@@ -537,17 +670,11 @@ void TimeSoundEditor_drawSound (TimeSoundEditor me, double globalMinimum, double
 				maximum = visibleMaximum;
 			}
 		} else if (my p_sound_scalingStrategy == kTimeSoundEditor_scalingStrategy::BY_WINDOW_AND_CHANNEL) {
-			if (longSound) {
-				LongSound_getWindowExtrema (longSound, my startWindow, my endWindow, ichan, & minimum, & maximum);
-			} else {
-				Matrix_getWindowExtrema (sound, first, last, ichan, ichan, & minimum, & maximum);
-			}
+			minimum = windowMinimum [ichan - firstVisibleChannel + 1];
+			maximum = windowMaximum [ichan - firstVisibleChannel + 1];
 		} else if (my p_sound_scalingStrategy == kTimeSoundEditor_scalingStrategy::FIXED_HEIGHT) {
-			if (longSound) {
-				LongSound_getWindowExtrema (longSound, my startWindow, my endWindow, ichan, & minimum, & maximum);
-			} else {
-				Matrix_getWindowExtrema (sound, first, last, ichan, ichan, & minimum, & maximum);
-			}
+			minimum = windowMinimum [ichan - firstVisibleChannel + 1];
+			maximum = windowMaximum [ichan - firstVisibleChannel + 1];
 			double channelExtent = my p_sound_scaling_height;
 			double middle = 0.5 * (minimum + maximum);
 			minimum = middle - 0.5 * channelExtent;
@@ -628,8 +755,14 @@ void TimeSoundEditor_drawSound (TimeSoundEditor me, double globalMinimum, double
 			if (cursorVisible && isdefined (cursorFunctionValue))
 				FunctionEditor_drawCursorFunctionValue (me, cursorFunctionValue, Melder_float (Melder_half (cursorFunctionValue)), U"");
 			Graphics_setColour (my graphics.get(), Graphics_BLACK);
-			Graphics_function (my graphics.get(), & sound -> z [ichan] [0], first, last,
-				Sampled_indexToX (sound, first), Sampled_indexToX (sound, last));
+			if (pyramid)
+				TimeSoundEditor_drawEnvelope (me, pyramid, ichan, first, last, Sampled_indexToX (sound, first), Sampled_indexToX (sound, last));
+			else
+				Graphics_function (my graphics.get(), & sound -> z [ichan] [0], first, last,
+					Sampled_indexToX (sound, first), Sampled_indexToX (sound, last));
+		} else if (pyramid) {
+			Graphics_setWindow (my graphics.get(), my startWindow, my endWindow, minimum, maximum);
+			TimeSoundEditor_drawEnvelope (me, pyramid, ichan, first, last, Sampled_indexToX (longSound, first), Sampled_indexToX (longSound, last));
 		} else {
 			Graphics_setWindow (my graphics.get(), my startWindow, my endWindow, minimum * 32768, maximum * 32768);
 			Graphics_function16 (my graphics.get(),
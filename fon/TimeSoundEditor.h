@@ -21,6 +21,7 @@
 #include "FunctionEditor.h"
 #include "Sound.h"
 #include "LongSound.h"
+#include "WaveformPyramid.h"
 
 #include "TimeSoundEditor_enums.h"
 
@@ -29,6 +30,7 @@ struct TimeSoundEditor_sound {
 	double minimum, maximum;
 	integer channelOffset;
 	bool *muteChannels;
+	autoWaveformPyramid pyramid;   // for a Sound built when first needed, invalid after the samples change; for a long LongSound built in steps when first needed
 };
 
 Thing_define (TimeSoundEditor, FunctionEditor) {
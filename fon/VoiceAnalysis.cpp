@@ -18,6 +18,9 @@
 
 #include "VoiceAnalysis.h"
 #include "AmplitudeTier.h"
+#include "Pitch_to_PointProcess.h"
+#include "Sound_to_Harmonicity.h"
+#include "Sound_to_Pitch.h"
 
 double PointProcess_getJitter_local (PointProcess me, double tmin, double tmax,
 	double pmin, double pmax, double maximumPeriodFactor)
@@ -361,4 +364,28 @@ void Sound_Pitch_PointProcess_voiceReport (Sound sound, Pitch pitch, PointProces
 	}
 }
 
+void Sound_to_Pitch_Harmonicity_PointProcess_cc (Sound me, double timeStep, double minimumPitch, double periodsPerWindow,
+	double silenceThreshold, double voicingThreshold, double octaveCost, double octaveJumpCost, double voicedUnvoicedCost,
+	double maximumPitch, double harmonicitySilenceThreshold,
+	autoPitch *out_pitch, autoHarmonicity *out_harmonicity, autoPointProcess *out_pulses)
+{
+	try {
+		/*
+			The candidates of Sound_to_Harmonicity_cc: all maxima of the cross-correlation below the Nyquist frequency.
+		*/
+		autoPitch pitch = Sound_to_Pitch_candidates (me, timeStep, minimumPitch, periodsPerWindow, 15, 3, 0.0, 0.0, 0.5 / my dx);
+		autoHarmonicity harmonicity = Pitch_to_Harmonicity (pitch.get(), harmonicitySilenceThreshold);
+		if (maximumPitch > 0.5 / my dx)
+			maximumPitch = 0.5 / my dx;
+		Pitch_pathFinder (pitch.get(), silenceThreshold, voicingThreshold,
+			octaveCost, octaveJumpCost, voicedUnvoicedCost, maximumPitch, Melder_debug == 31 ? true : false);
+		autoPointProcess pulses = Sound_Pitch_to_PointProcess_cc (me, pitch.get());
+		*out_pitch = pitch.move();
+		*out_harmonicity = harmonicity.move();
+		*out_pulses = pulses.move();
+	} catch (MelderError) {
+		Melder_throw (me, U": periodicity analysis not performed.");
+	}
+}
+
 /* End of file VoiceAnalysis.cpp */
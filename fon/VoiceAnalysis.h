@@ -19,6 +19,7 @@
 #include "Sound.h"
 #include "PointProcess.h"
 #include "Pitch.h"
+#include "Harmonicity.h"
 
 double PointProcess_getJitter_local (PointProcess me, double tmin, double tmax,
 	double minimumPeriod, double maximumPeriod, double maximumPeriodFactor);
@@ -52,4 +53,17 @@ void Sound_Pitch_PointProcess_voiceReport (Sound sound, Pitch pitch, PointProces
 	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor,
 	double silenceThreshold, double voicingThreshold);
 
+void Sound_to_Pitch_Harmonicity_PointProcess_cc (Sound me, double timeStep, double minimumPitch, double periodsPerWindow,
+	double silenceThreshold, double voicingThreshold, double octaveCost, double octaveJumpCost, double voicedUnvoicedCost,
+	double maximumPitch, double harmonicitySilenceThreshold,
+	autoPitch *out_pitch, autoHarmonicity *out_harmonicity, autoPointProcess *out_pulses);
+/*
+	One accurate cross-correlation periodicity analysis (Sound_to_Pitch_candidates)
+	for the three objects that a voice report needs.
+	The Harmonicity is identical to that of Sound_to_Harmonicity_cc (me, timeStep, minimumPitch, harmonicitySilenceThreshold, periodsPerWindow).
+	The Pitch is found by the path finder from the same candidates; since these have not been preselected
+	with the voicing threshold and the octave cost, it can differ from Sound_to_Pitch_cc in weakly voiced frames.
+	The pulses are those of Sound_Pitch_to_PointProcess_cc.
+*/
+
 /* End of file VoiceAnalysis.h */
@@ -0,0 +1,264 @@
+/* WaveformPyramid.cpp
+ *
+ * Copyright (C) 2026 Paul Boersma
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WaveformPyramid.h"
+
+Thing_implement (WaveformPyramid, Thing, 0);
+
+static integer numberOfBlocks (integer numberOfSamples, integer ilevel) {
+	return (numberOfSamples - 1) / WaveformPyramid_getBlockSize (ilevel) + 1;
+}
+
+static autoWaveformPyramid WaveformPyramid_create (integer numberOfChannels, integer numberOfSamples) {
+	Melder_assert (numberOfSamples >= 1);
+	autoWaveformPyramid me = Thing_new (WaveformPyramid);
+	my numberOfChannels = numberOfChannels;
+	my numberOfSamples = numberOfSamples;
+	my numberOfLevels = 1;
+	while (my numberOfLevels < WaveformPyramid_MAXIMUM_NUMBER_OF_LEVELS && numberOfBlocks (numberOfSamples, my numberOfLevels) > 1)
+		my numberOfLevels ++;
+	for (integer ilevel = 1; ilevel <= my numberOfLevels; ilevel ++) {
+		const integer n = numberOfBlocks (numberOfSamples, ilevel);
+		my minimum [ilevel] = newMATraw (numberOfChannels, n);
+		my maximum [ilevel] = newMATraw (numberOfChannels, n);
+	}
+	return me;
+}
+
+static void WaveformPyramid_computeHigherLevels (WaveformPyramid me) {
+	for (integer ilevel = 2; ilevel <= my numberOfLevels; ilevel ++) {
+		constMAT lowerMinimum = my minimum [ilevel - 1].get(), lowerMaximum = my maximum [ilevel - 1].get();
+		MAT minimum = my minimum [ilevel].get(), maximum = my maximum [ilevel].get();
+		for (integer ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+			for (integer iblock = 1; iblock <= minimum.ncol; iblock ++) {
+				const integer ilower = 2 * iblock - 1;
+				minimum [ichan] [iblock] = lowerMinimum [ichan] [ilower];
+				maximum [ichan] [iblock] = lowerMaximum [ichan] [ilower];
+				if (ilower + 1 <= lowerMinimum.ncol) {
+					if (lowerMinimum [ichan] [ilower + 1] < minimum [ichan] [iblock])
+						minimum [ichan] [iblock] = lowerMinimum [ichan] [ilower + 1];
+					if (lowerMaximum [ichan] [ilower + 1] > maximum [ichan] [iblock])
+						maximum [ichan] [iblock] = lowerMaximum [ichan] [ilower + 1];
+				}
+			}
+		}
+	}
+}
+
+autoWaveformPyramid WaveformPyramid_createFromSound (Sound sound) {
+	try {
+		autoWaveformPyramid me = WaveformPyramid_create (sound -> ny, sound -> nx);
+		const integer blockSize = WaveformPyramid_getBlockSize (1);
+		for (integer ichan = 1; ichan <= sound -> ny; ichan ++) {
+			for (integer iblock = 1; iblock <= my minimum [1].ncol; iblock ++) {
+				const integer ifirst = (iblock - 1) * blockSize + 1, ilast = std::min (iblock * blockSize, sound -> nx);
+				double minimum = sound -> z [ichan] [ifirst], maximum = minimum;
+				for (integer i = ifirst + 1; i <= ilast; i ++) {
+					const double value = sound -> z [ichan] [i];
+					if (value < minimum)
+						minimum = value;
+					else if (value > maximum)
+						maximum = value;
+				}
+				my minimum [1] [ichan] [iblock] = minimum;
+				my maximum [1] [ichan] [iblock] = maximum;
+			}
+		}
+		my numberOfBlocksRead = my minimum [1].ncol;
+		WaveformPyramid_computeHigherLevels (me.get());
+		return me;
+	} catch (MelderError) {
+		Melder_throw (sound, U": waveform pyramid not computed.");
+	}
+}
+
+autoWaveformPyramid WaveformPyramid_createFromLongSound_start (LongSound longSound) {
+	try {
+		return WaveformPyramid_create (longSound -> numberOfChannels, longSound -> nx);
+	} catch (MelderError) {
+		Melder_throw (longSound, U": waveform pyramid not created.");
+	}
+}
+
+bool WaveformPyramid_createFromLongSound_step (WaveformPyramid me, LongSound longSound, double maximumDuration) {
+	try {
+		Melder_assert (longSound -> nx == my numberOfSamples && longSound -> numberOfChannels == my numberOfChannels);
+		const integer blockSize = WaveformPyramid_getBlockSize (1), numberOfBlocksPerChunk = 1024;
+		const integer numberOfChannels = my numberOfChannels, numberOfBlocks = my minimum [1].ncol;
+		if (my numberOfBlocksRead == numberOfBlocks)
+			return true;
+		autovector <int16> buffer = newvectorraw <int16> ((blockSize * numberOfBlocksPerChunk + 1) * numberOfChannels);   // the compressed readers write one sample further
+		const double startTime = Melder_clock ();
+		do {
+			const integer firstBlock = my numberOfBlocksRead + 1;
+			const integer lastBlock = std::min (firstBlock + numberOfBlocksPerChunk - 1, numberOfBlocks);
+			const integer firstSample = (firstBlock - 1) * blockSize + 1;
+			const integer numberOfSamples = std::min (lastBlock * blockSize, longSound -> nx) - firstSample + 1;
+			LongSound_readAudioToShort (longSound, & buffer [1], firstSample, numberOfSamples);
+			for (integer iblock = firstBlock; iblock <= lastBlock; iblock ++) {
+				const integer ifirst = (iblock - firstBlock) * blockSize;   // offset into the chunk
+				const integer ilast = std::min (ifirst + blockSize, numberOfSamples) - 1;
+				for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
+					const int16 *samples = & buffer [1 + ichan - 1];
+					int16 minimum = samples [ifirst * numberOfChannels], maximum = minimum;
+					for (integer i = ifirst + 1; i <= ilast; i ++) {
+						const int16 value = samples [i * numberOfChannels];
+						if (value < minimum)
+							minimum = value;
+						else if (value > maximum)
+							maximum = value;
+					}
+					my minimum [1] [ichan] [iblock] = minimum / 32768.0;
+					my maximum [1] [ichan] [iblock] = maximum / 32768.0;
+				}
+			}
+			my numberOfBlocksRead = lastBlock;
+		} while (my numberOfBlocksRead < numberOfBlocks && Melder_clock () - startTime < maximumDuration);
+		if (my numberOfBlocksRead < numberOfBlocks)
+			return false;
+		WaveformPyramid_computeHigherLevels (me);
+		return true;
+	} catch (MelderError) {
+		Melder_throw (longSound, U": waveform pyramid not computed.");
+	}
+}
+
+static void WaveformPyramid_getBlockExtrema (WaveformPyramid me, integer ilevel, integer channel, integer ifirst, integer ilast,
+	double *inout_minimum, double *inout_maximum)
+{
+	const integer blockSize = WaveformPyramid_getBlockSize (ilevel);
+	const integer firstBlock = (ifirst - 1) / blockSize + 1, lastBlock = (ilast - 1) / blockSize + 1;
+	constVEC minimum = my minimum [ilevel] [channel], maximum = my maximum [ilevel] [channel];
+	for (integer iblock = firstBlock; iblock <= lastBlock; iblock ++) {
+		if (minimum [iblock] < *inout_minimum)
+			*inout_minimum = minimum [iblock];
+		if (maximum [iblock] > *inout_maximum)
+			*inout_maximum = maximum [iblock];
+	}
+}
+
+void WaveformPyramid_getEnvelope (WaveformPyramid me, integer channel, integer ifirst, integer ilast, VEC const& minimum, VEC const& maximum) {
+	Melder_assert (channel >= 1 && channel <= my numberOfChannels);
+	Melder_assert (ifirst >= 1 && ilast <= my numberOfSamples && ilast >= ifirst);
+	Melder_assert (maximum.size == minimum.size);
+	const integer numberOfColumns = minimum.size, numberOfSamples = ilast - ifirst + 1;
+	integer ilevel = 1;
+	while (ilevel < my numberOfLevels && WaveformPyramid_getBlockSize (ilevel + 1) <= numberOfSamples / numberOfColumns)
+		ilevel ++;
+	for (integer icol = 1; icol <= numberOfColumns; icol ++) {
+		const integer columnFirst = ifirst + (icol - 1) * numberOfSamples / numberOfColumns;
+		const integer columnLast = std::max (ifirst + icol * numberOfSamples / numberOfColumns - 1, columnFirst);
+		minimum [icol] = + INFINITY;
+		maximum [icol] = - INFINITY;
+		WaveformPyramid_getBlockExtrema (me, ilevel, channel, columnFirst, columnLast, & minimum [icol], & maximum [icol]);
+	}
+}
+
+void WaveformPyramid_getWholeBlocks (WaveformPyramid me, integer ifirst, integer ilast, integer *out_firstSample, integer *out_lastSample) {
+	const integer blockSize = WaveformPyramid_getBlockSize (1);
+	*out_firstSample = ((ifirst - 1 + blockSize - 1) / blockSize) * blockSize + 1;
+	*out_lastSample = ( ilast >= my numberOfSamples ? my numberOfSamples : (ilast / blockSize) * blockSize );   // the last block may be short
+}
+
+void WaveformPyramid_getExtrema (WaveformPyramid me, integer channel, integer ifirst, integer ilast, double *out_minimum, double *out_maximum) {
+	Melder_assert (channel >= 1 && channel <= my numberOfChannels);
+	Melder_assert (ifirst >= 1 && ilast <= my numberOfSamples && ilast >= ifirst);
+	const integer blockSize = WaveformPyramid_getBlockSize (1);
+	Melder_assert ((ifirst - 1) % blockSize == 0 && (ilast % blockSize == 0 || ilast == my numberOfSamples));
+	/*
+		Climb the pyramid from the finest level. Block `iblock` of a level is half of block `(iblock + 1) / 2` of the next level,
+		so a block at an edge of the range that shares its parent with a block outside the range is taken at its own level;
+		the remaining blocks pair up into whole blocks of the next level.
+	*/
+	integer firstBlock = (ifirst - 1) / blockSize + 1, lastBlock = (ilast - 1) / blockSize + 1;
+	double minimum = + INFINITY, maximum = - INFINITY;
+	for (integer ilevel = 1; firstBlock <= lastBlock; ilevel ++) {
+		constVEC levelMinimum = my minimum [ilevel] [channel], levelMaximum = my maximum [ilevel] [channel];
+		if (ilevel == my numberOfLevels) {
+			for (integer iblock = firstBlock; iblock <= lastBlock; iblock ++) {
+				minimum = std::min (minimum, levelMinimum [iblock]);
+				maximum = std::max (maximum, levelMaximum [iblock]);
+			}
+			break;
+		}
+		if (firstBlock % 2 == 0) {   // a right half, whose left half is outside the range
+			minimum = std::min (minimum, levelMinimum [firstBlock]);
+			maximum = std::max (maximum, levelMaximum [firstBlock]);
+			firstBlock ++;
+		}
+		if (lastBlock >= firstBlock && lastBlock % 2 == 1) {   // a left half, whose right half is outside the range (or absent)
+			minimum = std::min (minimum, levelMinimum [lastBlock]);
+			maximum = std::max (maximum, levelMaximum [lastBlock]);
+			lastBlock --;
+		}
+		firstBlock = (firstBlock + 1) / 2;
+		lastBlock = lastBlock / 2;
+	}
+	if (out_minimum)
+		*out_minimum = minimum;
+	if (out_maximum)
+		*out_maximum = maximum;
+}
+
+void test_WaveformPyramid (MelderFile file, integer numberOfRanges) {
+	MelderInfo_writeLine (U"test_WaveformPyramid: ", MelderFile_name (file));
+	autoSound sound = Sound_readFromSoundFile (file);
+	autoLongSound longSound = LongSound_open (file);
+	autoWaveformPyramid pyramid = WaveformPyramid_createFromSound (sound.get());
+	/*
+		The LongSound pyramid, read in the smallest possible steps, has to be identical to the Sound pyramid,
+		because both contain the same 16-bit samples.
+	*/
+	autoWaveformPyramid longPyramid = WaveformPyramid_createFromLongSound_start (longSound.get());
+	integer numberOfSteps = 1;
+	while (! WaveformPyramid_createFromLongSound_step (longPyramid.get(), longSound.get(), 0.0))
+		numberOfSteps ++;
+	Melder_require (WaveformPyramid_isComplete (longPyramid.get()) && longPyramid -> numberOfLevels == pyramid -> numberOfLevels,
+		U"The LongSound pyramid should be complete and as high as the Sound pyramid.");
+	for (integer ilevel = 1; ilevel <= pyramid -> numberOfLevels; ilevel ++)
+		Melder_require (NUMequal (longPyramid -> minimum [ilevel].get(), pyramid -> minimum [ilevel].get()) &&
+				NUMequal (longPyramid -> maximum [ilevel].get(), pyramid -> maximum [ilevel].get()),
+			U"The LongSound pyramid should equal the Sound pyramid at level ", ilevel, U".");
+	/*
+		The extrema of random stretches of whole blocks have to be the exact extrema of the samples.
+	*/
+	const integer numberOfSamples = sound -> nx, blockSize = WaveformPyramid_getBlockSize (1);
+	for (integer irange = 1; irange <= numberOfRanges; irange ++) {
+		integer ifirst = NUMrandomInteger (1, numberOfSamples), ilast = NUMrandomInteger (1, numberOfSamples);
+		if (ilast < ifirst)
+			std::swap (ifirst, ilast);
+		integer firstWhole, lastWhole;
+		WaveformPyramid_getWholeBlocks (pyramid.get(), ifirst, ilast, & firstWhole, & lastWhole);
+		Melder_require (firstWhole >= ifirst && firstWhole - ifirst < blockSize && (firstWhole - 1) % blockSize == 0,
+			U"Wrong first whole block for range ", ifirst, U"..", ilast, U".");
+		Melder_require (lastWhole <= ilast && ilast - lastWhole < blockSize && (lastWhole % blockSize == 0 || lastWhole == numberOfSamples),
+			U"Wrong last whole block for range ", ifirst, U"..", ilast, U".");
+		if (lastWhole < firstWhole)
+			continue;
+		for (integer ichan = 1; ichan <= sound -> ny; ichan ++) {
+			double minimum, maximum;
+			WaveformPyramid_getExtrema (pyramid.get(), ichan, firstWhole, lastWhole, & minimum, & maximum);
+			constVEC samples = sound -> z.row (ichan).part (firstWhole, lastWhole);
+			Melder_require (minimum == NUMmin (samples) && maximum == NUMmax (samples),
+				U"Wrong extrema for samples ", firstWhole, U"..", lastWhole, U" of channel ", ichan, U".");
+		}
+	}
+	MelderInfo_writeLine (U"test_WaveformPyramid: OK (", numberOfSamples, U" samples, ", numberOfSteps, U" steps)");
+}
+
+/* End of file WaveformPyramid.cpp */
@@ -0,0 +1,82 @@
+#ifndef _WaveformPyramid_h_
+#define _WaveformPyramid_h_
+/* WaveformPyramid.h
+ *
+ * Copyright (C) 2026 Paul Boersma
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LongSound.h"
+
+/*
+	The minimum and maximum of every block of 256, 512, 1024... samples of every channel,
+	so that a waveform can be drawn at any zoom level in a time proportional to the number of pixels
+	rather than to the number of samples. The blocks of level `ilevel` contain 2^(7 + ilevel) samples.
+*/
+#define WaveformPyramid_MAXIMUM_NUMBER_OF_LEVELS  40
+
+Thing_define (WaveformPyramid, Thing) {
+	integer numberOfChannels, numberOfSamples;
+	integer numberOfLevels;
+	integer numberOfBlocksRead;   // of the finest level; the pyramid is complete when all of them have been read
+	autoMAT minimum [1 + WaveformPyramid_MAXIMUM_NUMBER_OF_LEVELS], maximum [1 + WaveformPyramid_MAXIMUM_NUMBER_OF_LEVELS];   // [level] [channel] [block]
+};
+
+autoWaveformPyramid WaveformPyramid_createFromSound (Sound sound);
+autoWaveformPyramid WaveformPyramid_createFromLongSound_start (LongSound longSound);
+bool WaveformPyramid_createFromLongSound_step (WaveformPyramid me, LongSound longSound, double maximumDuration);
+/*
+	Reading the whole file can take long, so it is done in steps: each step reads chunks of the file
+	until at least `maximumDuration` seconds have passed, and returns whether the pyramid is complete.
+	The values are in the same units as those of a Sound (-1 to +1).
+*/
+
+inline bool WaveformPyramid_isComplete (WaveformPyramid me) {
+	return my numberOfBlocksRead == my minimum [1].ncol;
+}
+
+inline integer WaveformPyramid_getBlockSize (integer ilevel) {
+	return (integer) 1 << (7 + ilevel);
+}
+
+void WaveformPyramid_getEnvelope (WaveformPyramid me, integer channel, integer ifirst, integer ilast, VEC const& minimum, VEC const& maximum);
+/*
+	Divides the samples ifirst..ilast into `minimum.size` equal columns, and computes the extrema of each column
+	from the coarsest level whose blocks still fit into a column. Each column can include up to one block
+	from its neighbours, which is less than a column.
+*/
+
+void WaveformPyramid_getWholeBlocks (WaveformPyramid me, integer ifirst, integer ilast, integer *out_firstSample, integer *out_lastSample);
+/*
+	The longest stretch of samples within ifirst..ilast that consists of whole blocks of the finest level.
+	If there is no such stretch, *out_lastSample will be less than *out_firstSample.
+	The samples outside this stretch but within ifirst..ilast (fewer than one block at each edge)
+	are not in the pyramid, so they have to be looked at separately.
+*/
+
+void WaveformPyramid_getExtrema (WaveformPyramid me, integer channel, integer ifirst, integer ilast, double *out_minimum, double *out_maximum);
+/*
+	The exact extrema of ifirst..ilast, in a number of steps proportional to the number of levels.
+	Precondition: ifirst..ilast consists of whole blocks, as computed by WaveformPyramid_getWholeBlocks.
+*/
+
+void test_WaveformPyramid (MelderFile file, integer numberOfRanges);
+/*
+	Compares the pyramids of a sound file read as a Sound and as a LongSound,
+	and the extrema of `numberOfRanges` random ranges with those of the samples themselves.
+*/
+
+/* End of file WaveformPyramid.h */
+#endif
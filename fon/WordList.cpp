@@ -16,6 +16,11 @@
  * along with this work. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "WordList.h"
 #include "../kar/longchar.h"
 
@@ -195,79 +200,192 @@ autoStrings WordList_to_Strings (WordList me) {
 	}
 }
 
-static integer gotoStart (WordList me, integer p) {
-	if (p <= 0) return 0;
-	-- p;
-	while (p >= 0 && my string [p] != U'\n') p --;
-	return p + 1;
-}
+/*
+	The automaton is built with the incremental algorithm for sorted words by Daciuk, Mihov, Watson & Watson (2000):
+	every new word shares its path with the previous word up to their common prefix,
+	and the rest of the path of the previous word is complete, so that its states can be replaced
+	by equivalent states that were made earlier, or else be registered as new.
+	Two states are equivalent if they are both final or both non-final and have the same edges to the same targets.
+*/
+struct WordListBuildState {
+	std::vector <std::pair <char32, integer>> edges;
+	bool isFinal;
+};
 
-static integer gotoNext (WordList me, integer p) {
-	if (p >= my length - 1) return my length;
-	while (my string [p] != U'\n') p ++;
-	return p + 1;
+static std::u32string WordListBuildState_signature (WordListBuildState const& state) {
+	std::u32string signature (1, state.isFinal ? U'1' : U'0');
+	for (const auto& edge : state.edges) {
+		signature += edge.first;
+		signature += (char32) edge.second;   // the number of states fits in 32 bits
+	}
+	return signature;
 }
 
-static integer gotoPrevious (WordList me, integer p) {
-	if (p <= 0) return -1;
-	if (my string [-- p] != U'\n') return -1;   // should not occur
-	if (p <= 0) return 0;   // if first word is empty
-	-- p;   // step from newline
-	while (p >= 0 && my string [p] != U'\n') p --;
-	return p + 1;
+static void WordList_makeAutomaton (WordList me) {
+	if (my automatonFirstEdge.size > 0)
+		return;
+	if (my length == 0)
+		my length = str32len (my string.get());
+	/*
+		Collect the words; they should be sorted, but a list read from an old or hand-made file might not be.
+	*/
+	std::vector <std::u32string_view> words;
+	for (const char32 *p = & my string [0]; *p != U'\0'; ) {
+		const char32 *newline = str32chr (p, U'\n');
+		const integer wordLength = ( newline ? newline - p : str32len (p) );
+		words.emplace_back (p, wordLength);
+		p += wordLength + ( newline ? 1 : 0 );
+	}
+	if (! std::is_sorted (words.begin (), words.end ()))
+		std::sort (words.begin (), words.end ());
+	/*
+		Build.
+	*/
+	std::vector <WordListBuildState> states (1);   // the start state has number 0 during building
+	std::vector <integer> freeStates;
+	std::unordered_map <std::u32string, integer> registeredStates;
+	registeredStates.reserve (words.size () * 2);
+	std::vector <integer> path { 0 };   // path [i] is the state after the first i characters of the previous word
+	auto replaceOrRegister = [&] (integer downToLength) {
+		for (integer i = (integer) path.size () - 1; i > downToLength; i --) {
+			const integer child = path [i], parent = path [i - 1];
+			std::u32string signature = WordListBuildState_signature (states [child]);
+			auto found = registeredStates.find (signature);
+			if (found != registeredStates.end ()) {
+				states [parent]. edges.back (). second = found -> second;
+				states [child]. edges.clear ();
+				freeStates.push_back (child);
+			} else {
+				registeredStates.emplace (std::move (signature), child);
+			}
+			path.pop_back ();
+		}
+	};
+	std::u32string_view previousWord;
+	bool isFirstWord = true;
+	for (const auto& word : words) {
+		if (! isFirstWord && word == previousWord)
+			continue;
+		integer commonPrefixLength = 0;
+		if (! isFirstWord)
+			while (commonPrefixLength < (integer) word.size () && commonPrefixLength < (integer) previousWord.size () &&
+					word [(size_t) commonPrefixLength] == previousWord [(size_t) commonPrefixLength])
+				commonPrefixLength ++;
+		replaceOrRegister (commonPrefixLength);
+		for (integer i = commonPrefixLength; i < (integer) word.size (); i ++) {
+			integer newState;
+			if (freeStates.empty ()) {
+				newState = (integer) states.size ();
+				states.emplace_back ();
+			} else {
+				newState = freeStates.back ();
+				freeStates.pop_back ();
+			}
+			states [newState]. isFinal = false;
+			states [path.back ()]. edges.emplace_back (word [(size_t) i], newState);
+			path.push_back (newState);
+		}
+		states [path.back ()]. isFinal = true;
+		previousWord = word;
+		isFirstWord = false;
+	}
+	replaceOrRegister (0);
+	/*
+		Freeze: number the states that are still in use, with the start state first.
+	*/
+	std::vector <int32> number (states.size (), 0);
+	integer numberOfStates = 0, numberOfEdges = 0;
+	number [0] = ++ numberOfStates;
+	numberOfEdges += (integer) states [0]. edges.size ();
+	for (const auto& registered : registeredStates) {
+		number [(size_t) registered.second] = ++ numberOfStates;
+		numberOfEdges += (integer) states [(size_t) registered.second]. edges.size ();
+	}
+	Melder_require (numberOfStates < INT32_MAX && numberOfEdges < INT32_MAX,
+		U"The word list is too large.");
+	my automatonFirstEdge = newvectorraw <int32> (numberOfStates + 1);
+	my automatonStateIsFinal = newvectorraw <bool> (numberOfStates);
+	my automatonEdgeLabel = newvectorraw <char32> (numberOfEdges);
+	my automatonEdgeTarget = newvectorraw <int32> (numberOfEdges);
+	std::vector <integer> stateWithNumber (states.size () + 1);
+	for (integer istate = 0; istate < (integer) states.size (); istate ++)
+		if (number [(size_t) istate] != 0)
+			stateWithNumber [(size_t) number [(size_t) istate]] = istate;
+	integer iedge = 0;
+	for (integer inumber = 1; inumber <= numberOfStates; inumber ++) {
+		const WordListBuildState& state = states [(size_t) stateWithNumber [(size_t) inumber]];
+		my automatonFirstEdge [inumber] = (int32) (iedge + 1);
+		my automatonStateIsFinal [inumber] = state.isFinal;
+		for (const auto& edge : state.edges) {
+			iedge ++;
+			my automatonEdgeLabel [iedge] = edge.first;
+			my automatonEdgeTarget [iedge] = number [(size_t) edge.second];
+		}
+	}
+	my automatonFirstEdge [numberOfStates + 1] = (int32) (iedge + 1);
 }
 
-static int compare (conststring32 word, conststring32 p) {
-	for (;;) {
-		if (*word == U'\0') {
-			if (*p == U'\n') return 0;
-			else return -1;   // word is substring of p
-		}
-		if (*p == U'\n') return +1;   // p is substring of word
-		if (*word < *p) return -1;
-		if (*word > *p) return +1;
-		word ++, p ++;
+static integer WordList_followEdge (WordList me, integer state, char32 label) {
+	integer low = my automatonFirstEdge [state], high = my automatonFirstEdge [state + 1] - 1;
+	while (low <= high) {
+		const integer mid = (low + high) / 2;
+		if (my automatonEdgeLabel [mid] < label)
+			low = mid + 1;
+		else if (my automatonEdgeLabel [mid] > label)
+			high = mid - 1;
+		else
+			return my automatonEdgeTarget [mid];
 	}
-	return 0;   // should not occur
+	return 0;
 }
 
-static char32 buffer [3333+1];
+static integer WordList_followString (WordList me, conststring32 string) {
+	WordList_makeAutomaton (me);
+	integer state = 1;
+	for (const char32 *p = & string [0]; *p != U'\0' && state != 0; p ++)
+		state = WordList_followEdge (me, state, *p);
+	return state;
+}
 
 bool WordList_hasWord (WordList me, conststring32 word) {
 	if (str32len (word) > 3333)
 		return false;
+	static char32 buffer [3 * 3333 + 1];   // genericizing can triple the length
 	Longchar_genericize32 (word, buffer);
-	if (! my length)
-		my length = str32len (my string.get());
-	integer p = my length / 2, d = p / 2;
-	while (d > 20) {
-		p = gotoStart (me, p);
-		int cf = compare (buffer, my string.get() + p);
-		if (cf == 0) return true;
-		if (cf < 0) p -= d; else p += d;
-		d /= 2;
+	const integer state = WordList_followString (me, buffer);
+	return state != 0 && my automatonStateIsFinal [state];
+}
+
+static void collectWords (WordList me, integer state, std::u32string& word, std::vector <std::u32string>& words) {
+	if (my automatonStateIsFinal [state])
+		words.push_back (word);
+	for (integer iedge = my automatonFirstEdge [state]; iedge < my automatonFirstEdge [state + 1]; iedge ++) {
+		word.push_back (my automatonEdgeLabel [iedge]);
+		collectWords (me, my automatonEdgeTarget [iedge], word, words);
+		word.pop_back ();
 	}
-	p = gotoStart (me, p);
-	int cf = compare (buffer, my string.get() + p);
-	if (cf == 0) return true;
-	if (cf > 0) {
-		for (;;) {
-			p = gotoNext (me, p);
-			if (p >= my length) return false;
-			cf = compare (buffer, my string.get() + p);
-			if (cf == 0) return true;
-			if (cf < 0) return false;
-		}
-	} else {
-		for (;;) {
-			p = gotoPrevious (me, p);
-			if (p < 0) return false;
-			cf = compare (buffer, my string.get() + p);
-			if (cf == 0) return true;
-			if (cf > 0) return false;
+}
+
+autoStrings WordList_extractWordsStartingWith (WordList me, conststring32 prefix) {
+	try {
+		autostring32 genericPrefix (3 * str32len (prefix));   // genericizing can triple the length
+		Longchar_genericize32 (prefix, genericPrefix.get());
+		std::vector <std::u32string> words;
+		const integer state = WordList_followString (me, genericPrefix.get());
+		if (state != 0) {
+			std::u32string word (genericPrefix.get());
+			collectWords (me, state, word, words);
 		}
+		autoStrings thee = Thing_new (Strings);
+		thy numberOfStrings = (integer) words.size ();
+		if (thy numberOfStrings > 0)
+			thy strings = autostring32vector (thy numberOfStrings);
+		for (integer i = 1; i <= thy numberOfStrings; i ++)
+			thy strings [i] = Melder_dup (words [(size_t) i - 1].c_str ());
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": words starting with \"", prefix, U"\" not extracted.");
 	}
-	return false;   // should not occur
 }
 
 /* End of file WordList.cpp */
@@ -26,6 +26,14 @@ autoWordList Strings_to_WordList (Strings me);
 autoStrings WordList_to_Strings (WordList me);
 
 bool WordList_hasWord (WordList me, conststring32 word);
+/*
+	In a time proportional to the length of the word, not to the logarithm of the size of the list.
+*/
+
+autoStrings WordList_extractWordsStartingWith (WordList me, conststring32 prefix);
+/*
+	In alphabetical order, in a time proportional to the number of words found.
+*/
 
 /* End of file WordList.h */
 #endif
@@ -27,6 +27,17 @@ oo_DEFINE_CLASS (WordList, Daata)
 	#if oo_DECLARING
 		oo_INTEGER (length)
 
+		/*
+			The minimal deterministic automaton that accepts exactly the words in `string`.
+			It is built by the first lookup and is not written to files.
+			State 1 is the start state; the edges that leave state `istate`, sorted by label,
+			are automatonFirstEdge [istate] .. automatonFirstEdge [istate + 1] - 1.
+		*/
+		autovector <int32> automatonFirstEdge;   // [istate], one more than the number of states
+		autovector <char32> automatonEdgeLabel;   // [iedge]
+		autovector <int32> automatonEdgeTarget;   // [iedge]
+		autovector <bool> automatonStateIsFinal;   // [istate]
+
 		void v_info ()
 			override;
 	#endif
@@ -3619,6 +3619,11 @@ DEFINITION (U"Don't activate the plugins at start-up.")
 TAG (U"##--pref-dir=#/var/www/praat_plugins")
 DEFINITION (U"Set the preferences directory to /var/www/praat_plugins (for instance). "
 	"This can come in handy if you require access to preference files and/or plugins that are not in your home directory.")
+TAG (U"##--profile=#/tmp/profile.json")
+DEFINITION (U"Measure how long each step of starting up takes (each library, the preferences, the start-up files, each plugin), "
+	"as well as the script and each command that it runs, and write the durations to /tmp/profile.json (for instance) when Praat quits. "
+	"The file is in the Trace Event Format, which can be viewed in Perfetto or in Chrome's $$chrome://tracing$, "
+	"or be compared between versions of Praat or of your script.")
 TAG (U"##--version")
 DEFINITION (U"Print the Praat version.")
 TAG (U"##--help")
@@ -34,6 +34,7 @@
 #include "SoundSet.h"
 #include "SpectrumEditor.h"
 #include "TextGrid_Sound.h"
+#include "VoiceAnalysis.h"
 #include "mp3.h"
 
 #include "praat_Sound.h"
@@ -1709,6 +1710,39 @@ DO
 	CONVERT_EACH_END (my name.get())
 }
 
+FORM (NEWMANY_Sound_to_Pitch_Harmonicity_PointProcess_cc, U"Sound: To Pitch & Harmonicity & PointProcess (cc)", nullptr) {
+	LABEL (U"Finding the candidates")
+	POSITIVE (timeStep, U"Time step (s)", U"0.01")
+	POSITIVE (pitchFloor, U"Pitch floor (Hz)", U"75.0")
+	POSITIVE (periodsPerWindow, U"Periods per window", U"1.0")
+	LABEL (U"Finding a path")
+	REAL (silenceThreshold, U"Silence threshold", U"0.03")
+	REAL (voicingThreshold, U"Voicing threshold", U"0.45")
+	REAL (octaveCost, U"Octave cost", U"0.01")
+	REAL (octaveJumpCost, U"Octave-jump cost", U"0.35")
+	REAL (voicedUnvoicedCost, U"Voiced / unvoiced cost", U"0.14")
+	POSITIVE (pitchCeiling, U"Pitch ceiling (Hz)", U"600.0")
+	LABEL (U"Harmonicity")
+	REAL (harmonicitySilenceThreshold, U"Harmonicity silence threshold", U"0.1")
+	OK
+DO
+	if (pitchCeiling <= pitchFloor)
+		Melder_throw (U"Your pitch ceiling should be greater than your pitch floor.");
+	LOOP {
+		iam (Sound);
+		autoPitch pitch;
+		autoHarmonicity harmonicity;
+		autoPointProcess pulses;
+		Sound_to_Pitch_Harmonicity_PointProcess_cc (me, timeStep, pitchFloor, periodsPerWindow,
+			silenceThreshold, voicingThreshold, octaveCost, octaveJumpCost, voicedUnvoicedCost, pitchCeiling,
+			harmonicitySilenceThreshold, & pitch, & harmonicity, & pulses);
+		praat_new (pitch.move(), my name.get());
+		praat_new (harmonicity.move(), my name.get());
+		praat_new (pulses.move(), my name.get());
+	}
+	END
+}
+
 FORM (NEW_Sound_to_PointProcess_extrema, U"Sound: To PointProcess (extrema)", nullptr) {
 	CHANNEL (channel, U"Channel (number, Left, or Right)", U"1")
 	BOOLEAN (includeMaxima, U"Include maxima", true)
@@ -2389,6 +2423,7 @@ void praat_Sound_init () {
 		praat_addAction1 (classSound, 0, U"To Harmonicity (cc)...", nullptr, 1, NEW_Sound_to_Harmonicity_cc);
 		praat_addAction1 (classSound, 0, U"To Harmonicity (ac)...", nullptr, 1, NEW_Sound_to_Harmonicity_ac);
 		praat_addAction1 (classSound, 0, U"To Harmonicity (gne)...", nullptr, 1, NEW_Sound_to_Harmonicity_gne);
+		praat_addAction1 (classSound, 0, U"To Pitch & Harmonicity & PointProcess (cc)...", nullptr, 1, NEWMANY_Sound_to_Pitch_Harmonicity_PointProcess_cc);
 		praat_addAction1 (classSound, 0, U"-- autocorrelation --", nullptr, 1, nullptr);
 		praat_addAction1 (classSound, 0, U"Autocorrelate...", nullptr, 1, NEW_Sound_autoCorrelate);
 	praat_addAction1 (classSound, 0, U"Analyse spectrum -", nullptr, 0, nullptr);
@@ -1545,6 +1545,15 @@ DIRECT (NEW_WordList_to_Strings) {
 	CONVERT_EACH_END (my name.get())
 }
 
+FORM (NEW_WordList_extractWordsStartingWith, U"WordList: Extract words starting with", nullptr) {
+	SENTENCE (prefix, U"Prefix", U"")
+	OK
+DO
+	CONVERT_EACH (WordList)
+		autoStrings result = WordList_extractWordsStartingWith (me, prefix);
+	CONVERT_EACH_END (my name.get())
+}
+
 DIRECT (NEW_WordList_upto_SpellingChecker) {
 	CONVERT_EACH (WordList)
 		autoSpellingChecker result = WordList_upto_SpellingChecker (me);
@@ -1691,6 +1700,7 @@ praat_addAction1 (classTextGrid, 0, U"Synthesize", nullptr, 0, nullptr);
 		praat_addAction1 (classWordList, 1, U"Has word...", nullptr, 0, BOOLEAN_WordList_hasWord);
 	praat_addAction1 (classWordList, 0, U"Analyze", nullptr, 0, nullptr);
 		praat_addAction1 (classWordList, 0, U"To Strings", nullptr, 0, NEW_WordList_to_Strings);
+		praat_addAction1 (classWordList, 0, U"Extract words starting with...", nullptr, 0, NEW_WordList_extractWordsStartingWith);
 	praat_addAction1 (classWordList, 0, U"Synthesize", nullptr, 0, nullptr);
 		praat_addAction1 (classWordList, 0, U"Up to SpellingChecker", nullptr, 0, NEW_WordList_upto_SpellingChecker);
 
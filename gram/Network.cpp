@@ -95,6 +95,7 @@ void Network_init (Network me, double spreadingRate, kNetwork_activityClippingRu
 	my nodes = NUMvector <structNetworkNode> (1, numberOfNodes);
 	my numberOfConnections = numberOfConnections;
 	my connections = NUMvector <structNetworkConnection> (1, numberOfConnections);
+	my neighboursAreValid = false;
 }
 
 autoNetwork Network_create (double spreadingRate, kNetwork_activityClippingRule activityClippingRule,
@@ -148,6 +149,7 @@ void Network_setWeight (Network me, integer connectionNumber, double weight) {
 		if (connectionNumber <= 0 || connectionNumber > my numberOfConnections)
 			Melder_throw (me, U": connection number (", connectionNumber, U") out of the range 1..", my numberOfConnections, U".");
 		my connections [connectionNumber]. weight = weight;
+		my neighbourWeightsAreValid = false;
 	} catch (MelderError) {
 		Melder_throw (me, U": weight not set.");
 	}
@@ -163,52 +165,120 @@ void Network_setClamping (Network me, integer nodeNumber, bool clamped) {
 	}
 }
 
-void Network_spreadActivities (Network me, integer numberOfSteps) {
-	for (integer istep = 1; istep <= numberOfSteps; istep ++) {
-		for (integer inode = 1; inode <= my numberOfNodes; inode ++) {
-			NetworkNode node = & my nodes [inode];
-			if (! node -> clamped)
-				node -> excitation -= my spreadingRate * my activityLeak * node -> excitation;
+static void Network_updateNeighbours (Network me) {
+	if (my neighbourStart.size != my numberOfNodes + 1 || my neighbourNode.size != 2 * my numberOfConnections)
+		my neighboursAreValid = false;
+	if (! my neighboursAreValid) {
+		/*
+			Count the neighbours of each node, then fill in the rows in the order of the connections,
+			so that each node sees its connections in the same order as a loop over all the connections would.
+		*/
+		autoINTVEC start = newINTVECzero (my numberOfNodes + 1);
+		for (integer iconn = 1; iconn <= my numberOfConnections; iconn ++) {
+			const NetworkConnection connection = & my connections [iconn];
+			Melder_require (connection -> nodeFrom >= 1 && connection -> nodeFrom <= my numberOfNodes &&
+					connection -> nodeTo >= 1 && connection -> nodeTo <= my numberOfNodes,
+				U"Connection ", iconn, U" refers to a node outside the range 1..", my numberOfNodes, U".");
+			start [connection -> nodeFrom] ++;
+			start [connection -> nodeTo] ++;
 		}
+		integer position = 1;
+		for (integer inode = 1; inode <= my numberOfNodes + 1; inode ++) {
+			const integer numberOfNeighbours = start [inode];
+			start [inode] = position;
+			position += numberOfNeighbours;
+		}
+		autoINTVEC next = newINTVECcopy (start.get());
+		autoINTVEC node = newINTVECraw (2 * my numberOfConnections), connection = newINTVECraw (2 * my numberOfConnections);
 		for (integer iconn = 1; iconn <= my numberOfConnections; iconn ++) {
-			NetworkConnection connection = & my connections [iconn];
-			NetworkNode nodeFrom = & my nodes [connection -> nodeFrom];
-			NetworkNode nodeTo = & my nodes [connection -> nodeTo];
-			double shunting = my connections [iconn]. weight >= 0.0 ? my shunting : 0.0;   // only for excitatory connections
-			if (! nodeFrom -> clamped)
-				nodeFrom -> excitation += my spreadingRate * nodeTo -> activity * (my connections [iconn]. weight - shunting * nodeFrom -> excitation);
-			if (! nodeTo -> clamped)
-				nodeTo -> excitation += my spreadingRate * nodeFrom -> activity * (my connections [iconn]. weight - shunting * nodeTo -> excitation);
+			const integer nodeFrom = my connections [iconn]. nodeFrom, nodeTo = my connections [iconn]. nodeTo;
+			node [next [nodeFrom]] = nodeTo;
+			connection [next [nodeFrom] ++] = iconn;
+			node [next [nodeTo]] = nodeFrom;
+			connection [next [nodeTo] ++] = iconn;
 		}
-		for (integer inode = 1; inode <= my numberOfNodes; inode ++) {
-			NetworkNode node = & my nodes [inode];
-			if (! node -> clamped) {
-				switch (my activityClippingRule) {
-					case kNetwork_activityClippingRule::SIGMOID:
-						node -> activity = my minimumActivity +
-							(my maximumActivity - my minimumActivity) * NUMsigmoid (node -> excitation - 0.5 * (my minimumActivity + my maximumActivity));
-					break;
-					case kNetwork_activityClippingRule::LINEAR:
-						if (node -> excitation < my minimumActivity) {
-							node -> activity = my minimumActivity;
-						} else if (node -> excitation > my maximumActivity) {
-							node -> activity = my maximumActivity;
-						} else {
-							node -> activity = node -> excitation;
-						}
-					break;
-					case kNetwork_activityClippingRule::TOP_SIGMOID:
-						if (node -> excitation <= my minimumActivity) {
-							node -> activity = my minimumActivity;
-						} else {
-							node -> activity = my minimumActivity +
-								(my maximumActivity - my minimumActivity) * (2.0 * NUMsigmoid (2.0 * (node -> excitation - my minimumActivity) / (my maximumActivity - my minimumActivity)) - 1.0);
-							trace (U"excitation ", node -> excitation, U", activity ", node -> activity);
-						}
-					break;
+		my neighbourStart = start.move();
+		my neighbourNode = node.move();
+		my neighbourConnection = connection.move();
+		my neighbourWeight = newVECraw (2 * my numberOfConnections);
+		my neighboursAreValid = true;
+		my neighbourWeightsAreValid = false;
+	}
+	if (! my neighbourWeightsAreValid) {
+		for (integer ineighbour = 1; ineighbour <= my neighbourWeight.size; ineighbour ++)
+			my neighbourWeight [ineighbour] = my connections [my neighbourConnection [ineighbour]]. weight;
+		my neighbourWeightsAreValid = true;
+	}
+}
+
+void Network_spreadActivities (Network me, integer numberOfSteps) {
+	try {
+		Network_updateNeighbours (me);
+		const constINTVEC start = my neighbourStart.get(), neighbour = my neighbourNode.get();
+		const constVEC weight = my neighbourWeight.get();
+		const double spreadingRate = my spreadingRate, leak = my spreadingRate * my activityLeak, shunting = my shunting;
+		const double minimumActivity = my minimumActivity, maximumActivity = my maximumActivity;
+		const double activityRange = maximumActivity - minimumActivity;
+		for (integer istep = 1; istep <= numberOfSteps; istep ++) {
+			/*
+				Every unclamped node gathers the activities of its neighbours from the previous step;
+				this is a sparse matrix-vector multiplication, except for the shunting of the excitatory connections,
+				which depends on the excitation of the receiving node itself.
+			*/
+			for (integer inode = 1; inode <= my numberOfNodes; inode ++) {
+				NetworkNode node = & my nodes [inode];
+				if (node -> clamped)
+					continue;
+				double excitation = node -> excitation;
+				excitation -= leak * excitation;
+				if (shunting == 0.0) {
+					/*
+						The terms do not depend on the excitation, so that they can be computed ahead of the summation.
+					*/
+					for (integer ineighbour = start [inode]; ineighbour < start [inode + 1]; ineighbour ++)
+						excitation += spreadingRate * my nodes [neighbour [ineighbour]]. activity * weight [ineighbour];
+				} else {
+					for (integer ineighbour = start [inode]; ineighbour < start [inode + 1]; ineighbour ++) {
+						const double nodeShunting = weight [ineighbour] >= 0.0 ? shunting : 0.0;   // only for excitatory connections
+						excitation += spreadingRate * my nodes [neighbour [ineighbour]]. activity * (weight [ineighbour] - nodeShunting * excitation);
+					}
 				}
+				node -> excitation = excitation;
+			}
+			/*
+				Only then clip the excitations into the new activities, in one pass per rule.
+			*/
+			switch (my activityClippingRule) {
+				case kNetwork_activityClippingRule::SIGMOID: {
+					const double midpoint = 0.5 * (minimumActivity + maximumActivity);
+					for (integer inode = 1; inode <= my numberOfNodes; inode ++) {
+						NetworkNode node = & my nodes [inode];
+						if (! node -> clamped)
+							node -> activity = minimumActivity + activityRange * NUMsigmoid (node -> excitation - midpoint);
+					}
+				} break;
+				case kNetwork_activityClippingRule::LINEAR: {
+					for (integer inode = 1; inode <= my numberOfNodes; inode ++) {
+						NetworkNode node = & my nodes [inode];
+						if (! node -> clamped)
+							node -> activity =
+								node -> excitation < minimumActivity ? minimumActivity :
+								node -> excitation > maximumActivity ? maximumActivity :
+								node -> excitation;
+					}
+				} break;
+				case kNetwork_activityClippingRule::TOP_SIGMOID: {
+					for (integer inode = 1; inode <= my numberOfNodes; inode ++) {
+						NetworkNode node = & my nodes [inode];
+						if (! node -> clamped)
+							node -> activity = node -> excitation <= minimumActivity ? minimumActivity :
+								minimumActivity + activityRange * (2.0 * NUMsigmoid (2.0 * (node -> excitation - minimumActivity) / activityRange) - 1.0);
+					}
+				} break;
 			}
 		}
+	} catch (MelderError) {
+		Melder_throw (me, U": activities not spread.");
 	}
 }
 
@@ -248,6 +318,7 @@ void Network_updateWeights (Network me) {
 		if (connection -> weight < my minimumWeight) connection -> weight = my minimumWeight;
 		else if (connection -> weight > my maximumWeight) connection -> weight = my maximumWeight;
 	}
+	my neighbourWeightsAreValid = false;
 }
 
 void Network_normalizeWeights (Network me, integer nodeMin, integer nodeMax, integer nodeFromMin, integer nodeFromMax, double newSum) {
@@ -274,6 +345,7 @@ void Network_normalizeWeights (Network me, integer nodeMin, integer nodeMax, int
 			}
 		}
 	}
+	my neighbourWeightsAreValid = false;
 }
 
 autoNetwork Network_create_rectangle (double spreadingRate, enum kNetwork_activityClippingRule activityClippingRule,
@@ -453,6 +525,7 @@ void Network_addConnection (Network me, integer nodeFrom, integer nodeTo, double
 		my connections [my numberOfConnections]. nodeTo = nodeTo;
 		my connections [my numberOfConnections]. weight = weight;
 		my connections [my numberOfConnections]. plasticity = plasticity;
+		my neighboursAreValid = false;
 	} catch (MelderError) {
 		Melder_throw (me, U": connection not added.");
 	}
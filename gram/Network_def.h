@@ -101,6 +101,16 @@ oo_DEFINE_CLASS (Network, Daata)
 	oo_STRUCT_VECTOR (NetworkConnection, connections, numberOfConnections)
 
 	#if oo_DECLARING
+		/*
+			The connections as seen from each node (compressed sparse rows), for Network_spreadActivities:
+			the neighbours of node `inode` are in neighbourNode [neighbourStart [inode] .. neighbourStart [inode + 1] - 1],
+			ordered by connection number. Not saved; rebuilt when the connections or their weights have changed.
+		*/
+		autoINTVEC neighbourStart;   // [1..numberOfNodes + 1]
+		autoINTVEC neighbourNode, neighbourConnection;   // [1..2 * numberOfConnections]
+		autoVEC neighbourWeight;   // [1..2 * numberOfConnections]
+		bool neighboursAreValid, neighbourWeightsAreValid;
+
 		void v_info ()
 			override;
 	#endif
@@ -73,6 +73,7 @@
  */
 
 #include "OTGrammar.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "OTGrammar_def.h"
@@ -306,7 +307,7 @@ Thing_implement (OTGrammar, Daata, 2);
 
 Thing_implement (OTHistory, TableOfReal, 0);
 
-static OTGrammar constraintCompare_grammar;
+static thread_local OTGrammar constraintCompare_grammar;   // thread_local, because virtual learners can sort their own grammars simultaneously
 
 static int constraintCompare (const void *first, const void *second) {
 	OTGrammar me = constraintCompare_grammar;
@@ -1789,6 +1790,165 @@ void OTGrammar_PairDistribution_learn (OTGrammar me, PairDistribution thee,
 	}
 }
 
+/*
+	The virtual learners are divided over the threads. Each thread has its own copy of the grammar,
+	which is reset to the initial rankings for every learner, and its own random stream,
+	which is reseeded for every learner from the seed and the learner number,
+	so that a learner depends neither on the other learners nor on the number of threads.
+*/
+Thing_define (OTGrammar_simulateLearners_Args, Thing) { public:
+	OTGrammar initialGrammar, grammar;
+	PairDistribution distribution;
+	integer firstLearner, lastLearner;
+	int threadNumber;
+	double evaluationNoise;
+	kOTGrammar_rerankingStrategy updateRule;
+	bool honourLocalRankings;
+	double initialPlasticity;
+	integer replicationsPerPlasticity;
+	double plasticityDecrement;
+	integer numberOfPlasticities;
+	double relativePlasticityNoise;
+	integer numberOfChews, numberOfTestReplications;
+	uint64 randomSeed;
+	MAT rankings;   // [learner] [constraint]
+	VEC errorRates;   // [learner]
+	bool failed;
+};
+
+Thing_implement (OTGrammar_simulateLearners_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE OTGrammar_simulateLearners_thread (OTGrammar_simulateLearners_Args me) {
+	OTGrammar initialGrammar = my initialGrammar, grammar = my grammar;
+	NUMrandom_useThreadNumber (my threadNumber);
+	try {
+		for (integer ilearner = my firstLearner; ilearner <= my lastLearner; ilearner ++) {
+			NUMrandom_initializeWithSeed_mt (my threadNumber, my randomSeed, (uint64) ilearner);
+			for (integer icons = 1; icons <= grammar -> numberOfConstraints; icons ++) {
+				OTGrammarConstraint constraint = & grammar -> constraints [icons], initialConstraint = & initialGrammar -> constraints [icons];
+				constraint -> ranking = initialConstraint -> ranking;
+				constraint -> disharmony = initialConstraint -> disharmony;
+				constraint -> plasticity = initialConstraint -> plasticity;
+				grammar -> index [icons] = initialGrammar -> index [icons];
+			}
+			double plasticity = my initialPlasticity;
+			for (integer iplasticity = 1; iplasticity <= my numberOfPlasticities; iplasticity ++) {
+				for (integer ireplication = 1; ireplication <= my replicationsPerPlasticity; ireplication ++) {
+					conststring32 input, output;
+					PairDistribution_peekPair (my distribution, & input, & output);
+					for (integer ichew = 1; ichew <= my numberOfChews; ichew ++)
+						OTGrammar_learnOne (grammar, input, output,
+							my evaluationNoise, my updateRule, my honourLocalRankings,
+							plasticity, my relativePlasticityNoise, true, false, nullptr);   // no warnings from other threads
+				}
+				plasticity *= my plasticityDecrement;
+			}
+			for (integer icons = 1; icons <= grammar -> numberOfConstraints; icons ++)
+				my rankings [ilearner] [icons] = grammar -> constraints [icons]. ranking;
+			my errorRates [ilearner] = 1.0 - OTGrammar_PairDistribution_getFractionCorrect (grammar, my distribution,
+				my evaluationNoise, my numberOfTestReplications);
+		}
+	} catch (MelderError) {
+		my failed = true;
+	}
+	NUMrandom_useThreadNumber (0);
+	MelderThread_RETURN;
+}
+
+autoTable OTGrammar_PairDistribution_simulateLearners (OTGrammar me, PairDistribution thee, integer numberOfLearners,
+	double evaluationNoise, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
+	double initialPlasticity, integer replicationsPerPlasticity, double plasticityDecrement,
+	integer numberOfPlasticities, double relativePlasticityNoise, integer numberOfChews,
+	integer numberOfTestReplications, integer randomSeed)
+{
+	try {
+		Melder_require (numberOfLearners >= 1,
+			U"The number of learners should be at least 1.");
+		Melder_require (numberOfTestReplications >= 1,
+			U"The number of test replications should be at least 1.");
+		Melder_require (randomSeed >= 0,
+			U"The random seed should not be negative.");
+		/*
+			Errors cannot be reported well from within the threads,
+			so check beforehand that every attested pair can be learned from.
+		*/
+		longdouble totalWeight = 0.0;
+		for (integer ipair = 1; ipair <= thy pairs.size; ipair ++) {
+			PairProbability pair = thy pairs.at [ipair];
+			if (pair -> weight <= 0.0)
+				continue;
+			totalWeight += pair -> weight;
+			Melder_require (pair -> string1 && pair -> string2,
+				U"Pair ", ipair, U" should have two strings.");
+			OTGrammarTableau tableau = & my tableaus [OTGrammar_getTableau (me, pair -> string1.get())];
+			integer icand = 1;
+			for (; icand <= tableau -> numberOfCandidates; icand ++)
+				if (str32equ (tableau -> candidates [icand]. output.get(), pair -> string2.get()))
+					break;
+			Melder_require (icand <= tableau -> numberOfCandidates,
+				U"Cannot generate adult output \"", pair -> string2.get(), U"\" for input \"", pair -> string1.get(), U"\".");
+		}
+		Melder_require (totalWeight > 0.0,
+			U"There should be at least one pair with a positive weight.");
+
+		if (randomSeed == 0)
+			randomSeed = NUMrandomInteger (1, 1000000000);   // from the interface stream, so that the learners are still independent of the threads
+		autoMAT rankings = newMATraw (numberOfLearners, my numberOfConstraints);
+		autoVEC errorRates = newVECraw (numberOfLearners);
+		const int numberOfThreads = (int) std::min ({ (integer) MelderThread_getNumberOfProcessors (), numberOfLearners, (integer) 16 });
+		std::vector <autoOTGrammar> grammars ((size_t) numberOfThreads);
+		std::vector <autoOTGrammar_simulateLearners_Args> args ((size_t) numberOfThreads);
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			grammars [(size_t) ithread - 1] = Data_copy (me);
+			autoOTGrammar_simulateLearners_Args arg = Thing_new (OTGrammar_simulateLearners_Args);
+			arg -> initialGrammar = me;
+			arg -> grammar = grammars [(size_t) ithread - 1].get();
+			arg -> distribution = thee;
+			arg -> firstLearner = 1 + (ithread - 1) * numberOfLearners / numberOfThreads;
+			arg -> lastLearner = ithread * numberOfLearners / numberOfThreads;
+			arg -> threadNumber = ithread;   // stream 0 remains for the interface
+			arg -> evaluationNoise = evaluationNoise;
+			arg -> updateRule = updateRule;
+			arg -> honourLocalRankings = honourLocalRankings;
+			arg -> initialPlasticity = initialPlasticity;
+			arg -> replicationsPerPlasticity = replicationsPerPlasticity;
+			arg -> plasticityDecrement = plasticityDecrement;
+			arg -> numberOfPlasticities = numberOfPlasticities;
+			arg -> relativePlasticityNoise = relativePlasticityNoise;
+			arg -> numberOfChews = numberOfChews;
+			arg -> numberOfTestReplications = numberOfTestReplications;
+			arg -> randomSeed = (uint64) randomSeed;
+			arg -> rankings = rankings.get();
+			arg -> errorRates = errorRates.get();
+			args [(size_t) ithread - 1] = arg.move();
+		}
+		MelderThread_run (OTGrammar_simulateLearners_thread, args.data(), numberOfThreads);
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++)
+			if (args [(size_t) ithread - 1] -> failed)
+				Melder_throw (U"Learner ", args [(size_t) ithread - 1] -> firstLearner, U" or a later one did not complete learning.");
+
+		autoTable result = Table_createWithoutColumnNames (numberOfLearners, 2 + my numberOfConstraints);
+		Table_setColumnLabel (result.get(), 1, U"Learner");
+		for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
+			autostring32 label = Melder_dup (my constraints [icons]. name.get());
+			for (char32 *p = label.get(); *p != U'\0'; p ++)
+				if (*p == U'\n')
+					*p = U' ';   // some constraint names have two lines
+			Table_setColumnLabel (result.get(), 1 + icons, label.get());
+		}
+		Table_setColumnLabel (result.get(), 2 + my numberOfConstraints, U"ErrorRate");
+		for (integer ilearner = 1; ilearner <= numberOfLearners; ilearner ++) {
+			Table_setNumericValue (result.get(), ilearner, 1, ilearner);
+			for (integer icons = 1; icons <= my numberOfConstraints; icons ++)
+				Table_setNumericValue (result.get(), ilearner, 1 + icons, rankings [ilearner] [icons]);
+			Table_setNumericValue (result.get(), ilearner, 2 + my numberOfConstraints, errorRates [ilearner]);
+		}
+		return result;
+	} catch (MelderError) {
+		Melder_throw (me, U" & ", thee, U": learners not simulated.");
+	}
+}
+
 static integer PairDistribution_getNumberOfAttestedOutputs (PairDistribution me, conststring32 input, conststring32 *out_attestedOutput) {
 	integer result = 0;
 	for (integer ipair = 1; ipair <= my pairs.size; ipair ++) {
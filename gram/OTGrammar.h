@@ -100,6 +100,18 @@ void OTGrammar_PairDistribution_learn (OTGrammar me, PairDistribution thee,
 	double evaluationNoise, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
 	double initialPlasticity, integer replicationsPerPlasticity, double plasticityDecrement,
 	integer numberOfPlasticities, double relativePlasticityNoise, integer numberOfChews);
+autoTable OTGrammar_PairDistribution_simulateLearners (OTGrammar me, PairDistribution thee, integer numberOfLearners,
+	double evaluationNoise, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
+	double initialPlasticity, integer replicationsPerPlasticity, double plasticityDecrement,
+	integer numberOfPlasticities, double relativePlasticityNoise, integer numberOfChews,
+	integer numberOfTestReplications, integer randomSeed);
+/*
+	Lets each of `numberOfLearners` virtual learners start from the rankings of `me`
+	and learn from `thee` as OTGrammar_PairDistribution_learn does; `me` itself does not change.
+	Returns a Table with the final rankings and the error rate of each learner.
+	With the same positive `randomSeed`, every learner comes out the same on every run and with any number of threads;
+	a `randomSeed` of 0 means a seed drawn at random.
+*/
 bool OTGrammar_PairDistribution_findPositiveWeights (OTGrammar me, PairDistribution thee, double weightFloor, double marginOfSeparation);
 void OTGrammar_learnOneFromPartialOutput (OTGrammar me, conststring32 partialAdultOutput,
 	double rankingSpreading, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
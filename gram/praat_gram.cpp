@@ -1175,6 +1175,31 @@ DO
 	MODIFY_FIRST_OF_TWO_WEAK_END
 }
 
+FORM (NEW_OTGrammar_PairDistribution_simulateLearners, U"OTGrammar & PairDistribution: Simulate learners", nullptr) {
+	NATURAL (numberOfLearners, U"Number of learners", U"100")
+	REAL (evaluationNoise, U"Evaluation noise", U"2.0")
+	OPTIONMENU_ENUM (kOTGrammar_rerankingStrategy, updateRule,
+			U"Update rule", kOTGrammar_rerankingStrategy::SYMMETRIC_ALL)
+	POSITIVE (initialPlasticity, U"Initial plasticity", U"1.0")
+	NATURAL (replicationsPerPlasticity, U"Replications per plasticity", U"100000")
+	REAL (plasticityDecrement, U"Plasticity decrement", U"0.1")
+	NATURAL (numberOfPlasticities, U"Number of plasticities", U"4")
+	REAL (relativePlasticitySpreading, U"Rel. plasticity spreading", U"0.1")
+	BOOLEAN (honourLocalRankings, U"Honour local rankings", true)
+	NATURAL (numberOfChews, U"Number of chews", U"1")
+	NATURAL (numberOfTestReplications, U"Test replications", U"10000")
+	INTEGER (randomSeed, U"Random seed (0 = random)", U"0")
+	OK
+DO
+	CONVERT_TWO (OTGrammar, PairDistribution)
+		autoTable result = OTGrammar_PairDistribution_simulateLearners (me, you, numberOfLearners,
+			evaluationNoise, updateRule, honourLocalRankings,
+			initialPlasticity, replicationsPerPlasticity,
+			plasticityDecrement, numberOfPlasticities, relativePlasticitySpreading, numberOfChews,
+			numberOfTestReplications, randomSeed);
+	CONVERT_TWO_END (my name.get(), U"_learners")
+}
+
 DIRECT (LIST_OTGrammar_PairDistribution_listObligatoryRankings) {
 	FIND_TWO (OTGrammar, PairDistribution)
 		OTGrammar_PairDistribution_listObligatoryRankings (me, you);
@@ -1855,6 +1880,7 @@ void praat_uvafon_gram_init () {
 	praat_addAction2 (classOTGrammar, 1, classDistributions, 1, U"Get fraction correct...", nullptr, 0, REAL_MODIFY_OTGrammar_Distributions_getFractionCorrect);
 	praat_addAction2 (classOTGrammar, 1, classDistributions, 1, U"List obligatory rankings...", nullptr, praat_HIDDEN, LIST_OTGrammar_Distributions_listObligatoryRankings);
 	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Learn...", nullptr, 0, MODIFY_OTGrammar_PairDistribution_learn);
+	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Simulate learners...", nullptr, 0, NEW_OTGrammar_PairDistribution_simulateLearners);
 	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Find positive weights...", nullptr, 0, MODIFY_OTGrammar_PairDistribution_findPositiveWeights);
 	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Get fraction correct...", nullptr, 0, REAL_MODIFY_OTGrammar_PairDistribution_getFractionCorrect);
 	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Get minimum number correct...", nullptr, 0, INTEGER_MODIFY_OTGrammar_PairDistribution_getMinimumNumberCorrect);
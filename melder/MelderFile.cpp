@@ -87,34 +87,51 @@ void MelderFile_write (MelderFile file, conststring32 string) {
 		return;
 	int64 length = str32len (string);
 	FILE *f = file -> filePointer;
+	/*
+		The 8-bit encodings are collected in a local buffer and written in chunks,
+		because a `putc` per character dominates the writing of large text files.
+	*/
+	constexpr integer bufferSize = 1024, maximumBytesPerCharacter = 4;
+	char buffer [bufferSize];
+	integer numberOfBytesInBuffer = 0;
 	if (file -> outputEncoding == kMelder_textOutputEncoding_ASCII || file -> outputEncoding == kMelder_textOutputEncoding_ISO_LATIN1) {
 		for (int64 i = 0; i < length; i ++) {
+			if (numberOfBytesInBuffer > bufferSize - maximumBytesPerCharacter) {
+				fwrite (buffer, 1, (size_t) numberOfBytesInBuffer, f);
+				numberOfBytesInBuffer = 0;
+			}
 			char kar = (char) (char8) string [i];   // truncate
 			if (kar == '\n' && file -> requiresCRLF)
-				putc (13, f);
-			putc (kar, f);
+				buffer [numberOfBytesInBuffer ++] = 13;
+			buffer [numberOfBytesInBuffer ++] = kar;
 		}
+		fwrite (buffer, 1, (size_t) numberOfBytesInBuffer, f);
 	} else if (file -> outputEncoding == (unsigned long) kMelder_textOutputEncoding::UTF8) {
 		for (int64 i = 0; i < length; i ++) {
+			if (numberOfBytesInBuffer > bufferSize - maximumBytesPerCharacter) {
+				fwrite (buffer, 1, (size_t) numberOfBytesInBuffer, f);
+				numberOfBytesInBuffer = 0;
+			}
 			char32 kar = string [i];
 			if (kar <= 0x00'007F) {
 				if (kar == U'\n' && file -> requiresCRLF)
-					putc (13, f);
-				putc ((int) kar, f);   // guarded conversion down
+					buffer [numberOfBytesInBuffer ++] = 13;
+				buffer [numberOfBytesInBuffer ++] = (char) kar;   // guarded conversion down
 			} else if (kar <= 0x00'07FF) {
-				putc (0xC0 | (kar >> 6), f);
-				putc (0x80 | (kar & 0x00'003F), f);
+				buffer [numberOfBytesInBuffer ++] = (char) (0xC0 | (kar >> 6));
+				buffer [numberOfBytesInBuffer ++] = (char) (0x80 | (kar & 0x00'003F));
 			} else if (kar <= 0x00'FFFF) {
-				putc (0xE0 | (kar >> 12), f);
-				putc (0x80 | ((kar >> 6) & 0x00'003F), f);
-				putc (0x80 | (kar & 0x00'003F), f);
+				buffer [numberOfBytesInBuffer ++] = (char) (0xE0 | (kar >> 12));
+				buffer [numberOfBytesInBuffer ++] = (char) (0x80 | ((kar >> 6) & 0x00'003F));
+				buffer [numberOfBytesInBuffer ++] = (char) (0x80 | (kar & 0x00'003F));
 			} else {
-				putc (0xF0 | (kar >> 18), f);
-				putc (0x80 | ((kar >> 12) & 0x00'003F), f);
-				putc (0x80 | ((kar >> 6) & 0x00'003F), f);
-				putc (0x80 | (kar & 0x00'003F), f);
+				buffer [numberOfBytesInBuffer ++] = (char) (0xF0 | (kar >> 18));
+				buffer [numberOfBytesInBuffer ++] = (char) (0x80 | ((kar >> 12) & 0x00'003F));
+				buffer [numberOfBytesInBuffer ++] = (char) (0x80 | ((kar >> 6) & 0x00'003F));
+				buffer [numberOfBytesInBuffer ++] = (char) (0x80 | (kar & 0x00'003F));
 			}
 		}
+		fwrite (buffer, 1, (size_t) numberOfBytesInBuffer, f);
 	} else {
 		for (int64 i = 0; i < length; i ++) {
 			char32 kar = string [i];
@@ -183,6 +183,16 @@ void NUMrandom_init () {
 	theInited = true;
 }
 
+void NUMrandom_initializeWithSeed_mt (int threadNumber, uint64 seed, uint64 subseed) {
+	Melder_assert (threadNumber >= 1 && threadNumber <= 16);
+	uint64 keys [3];
+	keys [0] = seed;
+	keys [1] = subseed;
+	keys [2] = UINT64_C (7320321686725470078);
+	states [threadNumber]. init_by_array64 (keys, 3);
+	states [threadNumber]. secondAvailable = false;   // no Gaussian left over from the previous sequence
+}
+
 /* Throughout the years, several versions for "zero or magic" have been proposed. Choose the fastest. */
 
 #define ZERO_OR_MAGIC_VERSION  3
@@ -196,8 +206,15 @@ void NUMrandom_init () {
 	#define ZERO_OR_MAGIC  mag01 [(int) (x & UINT64_C (1))]
 #endif
 
+static thread_local int theCurrentThreadNumber = 0;
+
+void NUMrandom_useThreadNumber (int threadNumber) {
+	Melder_assert (threadNumber >= 0 && threadNumber <= 16);
+	theCurrentThreadNumber = threadNumber;
+}
+
 double NUMrandomFraction () {
-	NUMrandom_State *me = & states [0];
+	NUMrandom_State *me = & states [theCurrentThreadNumber];
 	uint64 x;
 
 	if (my index >= NN) {   // generate NN words at a time
@@ -281,7 +298,7 @@ double NUMrandomBernoulli_real (double probability) {
 #define repeat  do
 #define until(cond)  while (! (cond))
 double NUMrandomGauss (double mean, double standardDeviation) {
-	NUMrandom_State *me = & states [0];
+	NUMrandom_State *me = & states [theCurrentThreadNumber];
 	/*
 		Knuth, p. 122.
 	*/
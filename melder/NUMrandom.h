@@ -25,6 +25,21 @@ void NUMrandom_init ();
 double NUMrandomFraction ();
 double NUMrandomFraction_mt (int threadNumber);
 
+void NUMrandom_useThreadNumber (int threadNumber);
+/*
+	From now on, NUMrandomFraction () and all the functions below that are built on it,
+	if called from the current thread, will draw from the same stream as NUMrandomFraction_mt (threadNumber).
+	Every thread starts on stream 0; threadNumber runs from 0 to 16.
+*/
+
+void NUMrandom_initializeWithSeed_mt (int threadNumber, uint64 seed, uint64 subseed);
+/*
+	Restarts the stream of NUMrandomFraction_mt (threadNumber) from a sequence that depends only on seed and subseed,
+	e.g. on a seed chosen by the user and a run number, so that runs are reproducible
+	regardless of how they are divided over the threads.
+	Stream 0, the stream of the interface, should not be reseeded this way.
+*/
+
 double NUMrandomUniform (double lowest, double highest);
 
 integer NUMrandomInteger (integer lowest, integer highest);
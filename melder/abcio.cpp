@@ -362,12 +362,17 @@ void texresetindent (MelderFile file) { file -> indent = 0; }
 	conststring32 s4, conststring32 s5, conststring32 s6, \
 	conststring32 s7, conststring32 s8, conststring32 s9
 
+static void writeIndentation (MelderFile file) {
+	static const char32 spaces [] = U"                                                                ";   // 64 spaces
+	constexpr integer maximumChunk = std::size (spaces) - 1;
+	for (integer remaining = file -> indent; remaining > 0; remaining -= maximumChunk)
+		MelderFile_write (file, & spaces [maximumChunk - std::min (remaining, maximumChunk)]);
+}
+
 void texputintro (MelderFile file, texput_UP_TO_NINE_NULLABLE_STRINGS) {
 	if (file -> verbose) {
 		MelderFile_write (file, U"\n");
-		for (int iindent = 1; iindent <= file -> indent; iindent ++) {
-			MelderFile_write (file, U" ");
-		}
+		writeIndentation (file);
 		MelderFile_write (file,
 			s1 && s1 [0] == U'd' && s1 [1] == U'_' ? & s1 [2] : & s1 [0],
 			s2 && s2 [0] == U'd' && s2 [1] == U'_' ? & s2 [2] : & s2 [0],
@@ -385,9 +390,7 @@ void texputintro (MelderFile file, texput_UP_TO_NINE_NULLABLE_STRINGS) {
 #define PUTLEADER  \
 	MelderFile_write (file, U"\n"); \
 	if (file -> verbose) { \
-		for (int iindent = 1; iindent <= file -> indent; iindent ++) { \
-			MelderFile_write (file, U" "); \
-		} \
+		writeIndentation (file); \
 		MelderFile_write (file, \
 			s1 && s1 [0] == U'd' && s1 [1] == U'_' ? & s1 [2] : & s1 [0], \
 			s2 && s2 [0] == U'd' && s2 [1] == U'_' ? & s2 [2] : & s2 [0], \
@@ -1494,6 +1497,93 @@ void binputr64 (double x, FILE *f) {
 	}
 }
 
+/*
+	Block versions of bingetr64 and binputr64.
+	The bytes are read or written with a single fread or fwrite per block,
+	and the conversion from and to the big-endian file format is a loop over 64-bit integers
+	that the compiler can turn into vectorized byte swaps.
+	The results are byte for byte the same as those of calling bingetr64 or binputr64 for every element:
+	when reading, infinities and NaNs become `undefined`; when writing (except for the native formats),
+	minus zero becomes plus zero and NaNs become plus infinity.
+*/
+static_assert (sizeof (double) == sizeof (uint64), "Block I/O of doubles requires 64-bit IEEE doubles.");
+
+void bingetr64block (double *x, integer n, FILE *f) {
+	try {
+		if (n <= 0)
+			return;
+		if (Melder_debug == 18 || Melder_debug == 181) {
+			for (integer i = 0; i < n; i ++)
+				x [i] = bingetr64 (f);
+			return;
+		}
+		if (fread (x, sizeof (double), (size_t) n, f) != (size_t) n)
+			readError (f, U"64-bit floating-point numbers.");
+		if (binario_doubleIEEE8msb)
+			return;
+		uint8 *bytes = reinterpret_cast <uint8 *> (x);
+		for (integer i = 0; i < n; i ++, bytes += 8) {
+			const uint64 bits =
+				(uint64) bytes [0] << 56 | (uint64) bytes [1] << 48 | (uint64) bytes [2] << 40 | (uint64) bytes [3] << 32 |
+				(uint64) bytes [4] << 24 | (uint64) bytes [5] << 16 | (uint64) bytes [6] << 8 | (uint64) bytes [7];
+			if ((bits & 0x7FF0'0000'0000'0000) == 0x7FF0'0000'0000'0000)   // Infinity or Not-a-Number
+				x [i] = undefined;
+			else
+				memcpy (& x [i], & bits, 8);
+		}
+	} catch (MelderError) {
+		Melder_throw (U"Floating-point numbers not read from binary file.");
+	}
+}
+
+void binputr64block (const double *x, integer n, FILE *f) {
+	try {
+		if (n <= 0)
+			return;
+		if (binario_doubleIEEE8msb && Melder_debug != 18 || Melder_debug == 181) {
+			if (fwrite (x, sizeof (double), (size_t) n, f) != (size_t) n)
+				writeError (U"64-bit floating-point numbers.");
+			return;
+		}
+		if (Melder_debug == 18) {
+			for (integer i = 0; i < n; i ++)
+				binputr64 (x [i], f);
+			return;
+		}
+		constexpr integer blockSize = 4096;
+		uint8 buffer [8 * blockSize];
+		for (integer first = 0; first < n; first += blockSize) {
+			const integer numberOfValues = std::min (blockSize, n - first);
+			uint8 *bytes = buffer;
+			for (integer i = first; i < first + numberOfValues; i ++, bytes += 8) {
+				uint64 bits;
+				memcpy (& bits, & x [i], 8);
+				if (! binario_doubleIEEE8lsb) {
+					/*
+						Follow the portable encoding of binputr64.
+					*/
+					if ((bits & 0x7FF0'0000'0000'0000) == 0x7FF0'0000'0000'0000)
+						bits = ( bits & 0x000F'FFFF'FFFF'FFFF ? 0x7FF0'0000'0000'0000 : bits );   // NaN becomes +Infinity
+					else if (bits == 0x8000'0000'0000'0000)
+						bits = 0;   // minus zero
+				}
+				bytes [0] = (uint8) (bits >> 56);
+				bytes [1] = (uint8) (bits >> 48);
+				bytes [2] = (uint8) (bits >> 40);
+				bytes [3] = (uint8) (bits >> 32);
+				bytes [4] = (uint8) (bits >> 24);
+				bytes [5] = (uint8) (bits >> 16);
+				bytes [6] = (uint8) (bits >> 8);
+				bytes [7] = (uint8) bits;
+			}
+			if (fwrite (buffer, 8, (size_t) numberOfValues, f) != (size_t) numberOfValues)
+				writeError (U"64-bit floating-point numbers.");
+		}
+	} catch (MelderError) {
+		Melder_throw (U"Floating-point numbers not written to binary file.");
+	}
+}
+
 void binputr80 (double x, FILE *f) {
 	try {
 		unsigned char bytes [10];
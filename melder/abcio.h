@@ -170,6 +170,11 @@ double bingetr64 (FILE *f);   void binputr64 (double x, FILE *f);
 	Denormalized: from 4.9e-324.
 	This is the native format of a `double` on Silicon Graphics Iris and PowerMac.
 */
+void bingetr64block (double *x, integer n, FILE *f);   void binputr64block (const double *x, integer n, FILE *f);
+/*
+	Read or write `n` consecutive real numbers x [0..n-1] in the format of bingetr64 and binputr64,
+	with the same results, but in a single fread or fwrite per block.
+*/
 
 double bingetr80 (FILE *f);   void binputr80 (double x, FILE *f);
 /*
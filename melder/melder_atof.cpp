@@ -17,6 +17,7 @@
  */
 
 #include "melder.h"
+#include <charconv>
 
 /**
 	Assume that the next thing that follows is a numeric string,
@@ -109,6 +110,23 @@ double Melder_a8tof (conststring8 string) noexcept {
 	if (! p)
 		return undefined;
 	Melder_assert (p - & string [0] > 0);
+	#if defined (__cpp_lib_to_chars)
+		/*
+			Fast path for the common case of a complete decimal number, such as in text files.
+			Anything else (a percent sign, an out-of-range value, trailing text that `strtod` might
+			still consume) goes through `strtod` as before; both round correctly.
+		*/
+		if (p [-1] != '%' && (*p == '\0' || Melder_isAsciiHorizontalOrVerticalSpace (*p))) {
+			const char *q = & string [0];
+			while (Melder_isAsciiHorizontalOrVerticalSpace (*q))
+				q ++;
+			if (*q == '+')
+				q ++;
+			double result;
+			if (std::from_chars (q, p, result). ec == std::errc ())
+				return result;
+		}
+	#endif
 	return p [-1] == '%' ? 0.01 * strtod (string, nullptr) : strtod (string, nullptr);
 }
 
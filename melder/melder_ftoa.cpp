@@ -17,6 +17,7 @@
  */
 
 #include "melder.h"
+#include <charconv>
 
 /********** NUMBER TO STRING CONVERSION **********/
 
@@ -40,9 +41,11 @@ const char * Melder8_integer (int64 value) noexcept {
 	if (++ ibuffer == NUMBER_OF_BUFFERS)
 		ibuffer = 0;
 	if (sizeof (long_not_integer) == 8) {
-		int n = snprintf (buffers8 [ibuffer], MAXIMUM_NUMERIC_STRING_LENGTH + 1, "%ld", (long_not_integer) value);   // cast to identical type, to make compiler happy
-		Melder_assert (n > 0);
-		Melder_assert (n <= MAXIMUM_NUMERIC_STRING_LENGTH);
+		/*
+			Same as "%ld", but without the format parsing, which matters when writing the indices of large text files.
+		*/
+		char *end = std::to_chars (buffers8 [ibuffer], buffers8 [ibuffer] + MAXIMUM_NUMERIC_STRING_LENGTH, value). ptr;
+		*end = '\0';
 	} else if (sizeof (long long) == 8) {
 		/*
 		 * There are buggy platforms (namely 32-bit Mingw on Windows XP) that support long long and %lld but that convert
@@ -140,18 +143,54 @@ conststring32 Melder_boolean (bool value) noexcept {
 /*@praat
 	assert string$ (1000000000000) = "1000000000000"
 	assert string$ (undefined) = "--undefined--"
+	assert string$ (0.1) = "0.1"
+	assert string$ (1/3) = "0.3333333333333333"
+	assert string$ (0.1 + 0.2) = "0.30000000000000004"
+	assert string$ (123456789012345678) = "1.2345678901234568e+17"
+	assert string$ (-1e-310) = "-9.99999999999997e-311"
 @*/
 const char * Melder8_double (double value) noexcept {
 	if (isundef (value))
 		return "--undefined--";
 	if (++ ibuffer == NUMBER_OF_BUFFERS)
 		ibuffer = 0;
-	sprintf (buffers8 [ibuffer], "%.15g", value);
-	if (strtod (buffers8 [ibuffer], nullptr) != value) {
-		sprintf (buffers8 [ibuffer], "%.16g", value);
-		if (strtod (buffers8 [ibuffer], nullptr) != value)
-			sprintf (buffers8 [ibuffer], "%.17g", value);
-	}
+	#if defined (__cpp_lib_to_chars)
+		/*
+			Same result as the three-step `sprintf` and `strtod` below, which is what text files contain,
+			but with the faster <charconv> conversions. Any precision below the number of significant digits
+			in the shortest round-trip representation cannot round-trip, so we can start there.
+		*/
+		char *text = buffers8 [ibuffer], *textEnd = text + MAXIMUM_NUMERIC_STRING_LENGTH;
+		const char *shortestEnd = std::to_chars (text, textEnd, value, std::chars_format::scientific). ptr;
+		int numberOfSignificantDigits = 0, numberOfTrailingZeroes = 0;
+		for (const char *p = text; p < shortestEnd && *p != 'e'; p ++) {
+			if (! Melder_isAsciiDecimalNumber (*p))
+				continue;
+			if (*p == '0') {
+				if (numberOfSignificantDigits > 0)
+					numberOfTrailingZeroes ++;
+			} else {
+				numberOfSignificantDigits += numberOfTrailingZeroes + 1;
+				numberOfTrailingZeroes = 0;
+			}
+		}
+		for (int precision = std::max (15, numberOfSignificantDigits); precision <= 17; precision ++) {
+			char *end = std::to_chars (text, textEnd, value, std::chars_format::general, precision). ptr;
+			*end = '\0';
+			if (precision == 17)
+				break;
+			double roundTrip;
+			if (std::from_chars (text, end, roundTrip). ec == std::errc () && roundTrip == value)
+				break;
+		}
+	#else
+		sprintf (buffers8 [ibuffer], "%.15g", value);
+		if (strtod (buffers8 [ibuffer], nullptr) != value) {
+			sprintf (buffers8 [ibuffer], "%.16g", value);
+			if (strtod (buffers8 [ibuffer], nullptr) != value)
+				sprintf (buffers8 [ibuffer], "%.17g", value);
+		}
+	#endif
 	return buffers8 [ibuffer];
 }
 conststring32 Melder_double (double value) noexcept {
@@ -138,12 +138,8 @@ bool Melder_stringMatchesCriterion (conststring32 value, kMelder_string which, c
 		}
 		case kMelder_string::MATCH_REGEXP:
 		{
-			char32 *place = nullptr;
-			regexp *compiled_regexp = CompileRE_throwable (criterion, ! REDFLT_CASE_INSENSITIVE);
-			if (ExecRE (compiled_regexp, nullptr, value, nullptr, 0, U'\0', U'\0', nullptr, nullptr))
-				place = compiled_regexp -> startp [0];
-			free (compiled_regexp);
-			return !! place;
+			regexp *compiled_regexp = CompileRE_cached (criterion, ! REDFLT_CASE_INSENSITIVE);
+			return !! ExecRE (compiled_regexp, nullptr, value, nullptr, 0, U'\0', U'\0', nullptr, nullptr);
 		}
 	}
 	//return false;   // should not occur
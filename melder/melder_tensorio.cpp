@@ -20,6 +20,41 @@
 
 /*** Typed I/O functions for vectors and matrices. ***/
 
+/*
+	Binary I/O of contiguous blocks of elements.
+	For 64-bit reals there are block versions that do a single fread or fwrite;
+	the other types are read and written element by element.
+*/
+#define BLOCK_IO_ELEMENTWISE(T,storage)  \
+	static void readBinaryBlock_##storage (T *x, integer n, FILE *f) { \
+		for (integer i = 0; i < n; i ++) \
+			x [i] = binget##storage (f); \
+	} \
+	static void writeBinaryBlock_##storage (const T *x, integer n, FILE *f) { \
+		for (integer i = 0; i < n; i ++) \
+			binput##storage (x [i], f); \
+	}
+
+BLOCK_IO_ELEMENTWISE (signed char, i8)
+BLOCK_IO_ELEMENTWISE (int, i16)
+BLOCK_IO_ELEMENTWISE (long, i32)
+BLOCK_IO_ELEMENTWISE (integer, integer32BE)
+BLOCK_IO_ELEMENTWISE (integer, integer16BE)
+BLOCK_IO_ELEMENTWISE (unsigned char, u8)
+BLOCK_IO_ELEMENTWISE (unsigned int, u16)
+BLOCK_IO_ELEMENTWISE (unsigned long, u32)
+BLOCK_IO_ELEMENTWISE (double, r32)
+BLOCK_IO_ELEMENTWISE (dcomplex, c64)
+BLOCK_IO_ELEMENTWISE (dcomplex, c128)
+#undef BLOCK_IO_ELEMENTWISE
+
+static void readBinaryBlock_r64 (double *x, integer n, FILE *f) {
+	bingetr64block (x, n, f);
+}
+static void writeBinaryBlock_r64 (const double *x, integer n, FILE *f) {
+	binputr64block (x, n, f);
+}
+
 #define FUNCTION(T,storage)  \
 	void NUMvector_writeText_##storage (const T *v, integer lo, integer hi, MelderFile file, conststring32 name) { \
 		texputintro (file, name, U" []: ", hi >= lo ? nullptr : U"(empty)", 0,0,0); \
@@ -36,13 +71,13 @@
 		if (feof (file -> filePointer) || ferror (file -> filePointer)) Melder_throw (U"Write error."); \
 	} \
 	void NUMvector_writeBinary_##storage (const T *v, integer lo, integer hi, FILE *f) { \
-		for (integer i = lo; i <= hi; i ++) \
-			binput##storage (v [i], f); \
+		if (hi >= lo) \
+			writeBinaryBlock_##storage (& v [lo], hi - lo + 1, f); \
 		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
 	} \
 	void vector_writeBinary_##storage (const constvector<T>& vec, FILE *f) { \
-		for (integer i = 1; i <= vec.size; i ++) \
-			binput##storage (vec [i], f); \
+		if (vec.size > 0) \
+			writeBinaryBlock_##storage (& vec [1], vec.size, f); \
 		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
 	} \
 	T * NUMvector_readText_##storage (integer lo, integer hi, MelderReadText text, const char *name) { \
@@ -77,9 +112,7 @@
 		T *result = nullptr; \
 		try { \
 			result = NUMvector <T> (lo, hi); \
-			for (integer i = lo; i <= hi; i ++) { \
-				result [i] = binget##storage (f); \
-			} \
+			readBinaryBlock_##storage (& result [lo], hi - lo + 1, f); \
 			return result; \
 		} catch (MelderError) { \
 			NUMvector_free (result, lo); \
@@ -88,9 +121,8 @@
 	} \
 	autovector<T> vector_readBinary_##storage (integer size, FILE *f) { \
 		autovector<T> result = newvectorzero<T> (size); \
-		for (integer i = 1; i <= size; i ++) { \
-			result [i] = binget##storage (f); \
-		} \
+		if (size > 0) \
+			readBinaryBlock_##storage (& result [1], size, f); \
 		return result; \
 	} \
 	void matrix_writeText_##storage (const constmatrix<T>& mat, MelderFile file, conststring32 name) { \
@@ -106,10 +138,8 @@
 		if (feof (file -> filePointer) || ferror (file -> filePointer)) Melder_throw (U"Write error."); \
 	} \
 	void matrix_writeBinary_##storage (const constmatrix<T>& mat, FILE *f) { \
-		for (integer irow = 1; irow <= mat.nrow; irow ++) { \
-			for (integer icol = 1; icol <= mat.ncol; icol ++) \
-				binput##storage (mat [irow] [icol], f); \
-		} \
+		if (mat.nrow > 0 && mat.ncol > 0) \
+			writeBinaryBlock_##storage (mat.cells, mat.nrow * mat.ncol, f);   /* the rows are contiguous */ \
 		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
 	} \
 	automatrix<T> matrix_readText_##storage (integer nrow, integer ncol, MelderReadText text, const char *name) { \
@@ -125,8 +155,8 @@
 	} \
 	automatrix<T> matrix_readBinary_##storage (integer nrow, integer ncol, FILE *f) { \
 		automatrix<T> result = newmatrixzero<T> (nrow, ncol); \
-		for (integer irow = 1; irow <= nrow; irow ++) for (integer icol = 1; icol <= ncol; icol ++) \
-			result [irow] [icol] = binget##storage (f); \
+		if (nrow > 0 && ncol > 0) \
+			readBinaryBlock_##storage (result.cells, nrow * ncol, f); \
 		return result; \
 	} \
 	void tensor3_writeText_##storage (const consttensor3<T>& ten3, MelderFile file, conststring32 name) { \
@@ -145,6 +175,12 @@
 		if (feof (file -> filePointer) || ferror (file -> filePointer)) Melder_throw (U"Write error."); \
 	} \
 	void tensor3_writeBinary_##storage (const consttensor3<T>& ten3, FILE *f) { \
+		if (ten3.stride3 == 1 && ten3.stride2 == ten3.ndim3 && ten3.stride1 == ten3.ndim2 * ten3.ndim3) { \
+			if (ten3.ndim1 > 0 && ten3.ndim2 > 0 && ten3.ndim3 > 0) \
+				writeBinaryBlock_##storage (ten3.cells, ten3.ndim1 * ten3.ndim2 * ten3.ndim3, f); \
+			if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
+			return; \
+		} \
 		for (integer idim1 = 1; idim1 <= ten3.ndim1; idim1 ++) { \
 			for (integer idim2 = 1; idim2 <= ten3.ndim2; idim2 ++) { \
 				for (integer idim3 = 1; idim3 <= ten3.ndim3; idim3 ++) { \
@@ -171,13 +207,9 @@
 	} \
 	autotensor3<T> tensor3_readBinary_##storage (integer ndim1, integer ndim2, integer ndim3, FILE *f) { \
 		autotensor3<T> result = newtensor3zero<T> (ndim1, ndim2, ndim3); \
-		for (integer idim1 = 1; idim1 <= result.ndim1; idim1 ++) { \
-			for (integer idim2 = 1; idim2 <= result.ndim2; idim2 ++) { \
-				for (integer idim3 = 1; idim3 <= result.ndim3; idim3 ++) { \
-					result [idim1] [idim2] [idim3] = binget##storage (f); \
-				} \
-			} \
-		} \
+		Melder_assert (result.stride3 == 1 && result.stride2 == ndim3 && result.stride1 == ndim2 * ndim3); \
+		if (ndim1 > 0 && ndim2 > 0 && ndim3 > 0) \
+			readBinaryBlock_##storage (result.cells, ndim1 * ndim2 * ndim3, f); \
 		return result; \
 	}
 
@@ -90,6 +90,7 @@
 
 #include <ctype.h>
 #include <limits.h>
+#include <algorithm>
 #include "melder.h"
 
 /* The first byte of the regexp internal `program' is a magic number to help
@@ -524,6 +525,45 @@ regexp *CompileRE_throwable (conststring32 exp, int defaultFlags) {
 	return compiledRE;
 }
 
+/*
+	The cache is per thread, because ExecRE writes the positions of the match into the regexp.
+	The entries are kept in order of use, the most recently used first.
+*/
+struct CompiledRECache {
+	struct Entry {
+		autostring32 expression;
+		int defaultFlags;
+		regexp *compiledRE;
+	} entries [CompileRE_CACHE_SIZE];
+	integer numberOfEntries = 0;
+	~CompiledRECache () {
+		for (integer i = 0; i < numberOfEntries; i ++)
+			free (entries [i]. compiledRE);
+	}
+};
+static thread_local CompiledRECache theCompiledRECache;
+
+regexp *CompileRE_cached (conststring32 exp, int defaultFlags) {
+	CompiledRECache& cache = theCompiledRECache;
+	for (integer i = 0; i < cache.numberOfEntries; i ++) {
+		CompiledRECache::Entry& entry = cache.entries [i];
+		if (entry. defaultFlags == defaultFlags && str32equ (entry. expression.get(), exp)) {
+			std::rotate (& cache.entries [0], & cache.entries [i], & cache.entries [i + 1]);   // move to the front
+			return cache.entries [0]. compiledRE;
+		}
+	}
+	autostring32 expression = Melder_dup (exp);
+	regexp *compiledRE = CompileRE_throwable (exp, defaultFlags);
+	if (cache.numberOfEntries == CompileRE_CACHE_SIZE)
+		free (cache.entries [-- cache.numberOfEntries]. compiledRE);   // forget the least recently used expression
+	std::rotate (& cache.entries [0], & cache.entries [cache.numberOfEntries], & cache.entries [cache.numberOfEntries + 1]);
+	cache.numberOfEntries += 1;
+	cache.entries [0]. expression = expression.move();
+	cache.entries [0]. defaultFlags = defaultFlags;
+	cache.entries [0]. compiledRE = compiledRE;
+	return compiledRE;
+}
+
 regexp *CompileRE (conststring32 exp, conststring32 *errorText, int defaultFlags) {
 
 	regexp *comp_regex = NULL;
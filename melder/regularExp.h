@@ -72,6 +72,16 @@ regexp * CompileRE (
 
 regexp *CompileRE_throwable (conststring32 exp, int defaultFlags);
 
+regexp *CompileRE_cached (conststring32 exp, int defaultFlags);
+/*
+	Like CompileRE_throwable, but the compiled expression is taken from (or put into) a small cache,
+	one per thread, of the most recently used expressions, so that matching the same expression
+	against many strings compiles it only once.
+	The result is owned by the cache and should not be freed; it remains valid
+	until the same thread has compiled CompileRE_CACHE_SIZE other expressions.
+*/
+#define CompileRE_CACHE_SIZE  16
+
 /* Match a `regexp' structure against a string. */
 
 int ExecRE (
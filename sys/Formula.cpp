@@ -4626,18 +4626,12 @@ static void do_stringMatchesCriterion (kMelder_string criterion) {
 static void do_index_regex (int backward) {
 	Stackel t = pop, s = pop;
 	if (s->which == Stackel_STRING && t->which == Stackel_STRING) {
-		conststring32 errorMessage;
-		regexp *compiled_regexp = CompileRE (t->getString(), & errorMessage, 0);
-		if (! compiled_regexp) {
-			Melder_throw (U"index_regex(): ", errorMessage, U".");
+		regexp *compiled_regexp = CompileRE_cached (t->getString(), 0);
+		if (ExecRE (compiled_regexp, nullptr, s->getString(), nullptr, backward, U'\0', U'\0', nullptr, nullptr)) {
+			char32 *location = (char32 *) compiled_regexp -> startp [0];
+			pushNumber (location - s->getString() + 1);
 		} else {
-			if (ExecRE (compiled_regexp, nullptr, s->getString(), nullptr, backward, U'\0', U'\0', nullptr, nullptr)) {
-				char32 *location = (char32 *) compiled_regexp -> startp [0];
-				pushNumber (location - s->getString() + 1);
-				free (compiled_regexp);
-			} else {
-				pushNumber (false);
-			}
+			pushNumber (false);
 		}
 	} else {
 		Melder_throw (U"The function \"", Formula_instructionNames [parse [programPointer]. symbol],
@@ -4656,14 +4650,9 @@ static void do_STRreplace () {
 static void do_STRreplace_regex () {
 	Stackel x = pop, u = pop, t = pop, s = pop;
 	if (s->which == Stackel_STRING && t->which == Stackel_STRING && u->which == Stackel_STRING && x->which == Stackel_NUMBER) {
-		conststring32 errorMessage;
-		regexp *compiled_regexp = CompileRE (t->getString(), & errorMessage, 0);
-		if (! compiled_regexp) {
-			Melder_throw (U"replace_regex$(): ", errorMessage, U".");
-		} else {
-			autostring32 result = newSTRreplace_regex (s->getString(), compiled_regexp, u->getString(), Melder_iround (x->number));
-			pushString (result.move());
-		}
+		regexp *compiled_regexp = CompileRE_cached (t->getString(), 0);
+		autostring32 result = newSTRreplace_regex (s->getString(), compiled_regexp, u->getString(), Melder_iround (x->number));
+		pushString (result.move());
 	} else {
 		Melder_throw (U"The function \"replace_regex$\" requires three strings and a number.");
 	}
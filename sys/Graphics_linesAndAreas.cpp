@@ -938,9 +938,48 @@ integer Graphics_function_ (Graphics me, const TYPE yWC [], integer stride, inte
 	return n;
 }
 
+/*
+	A function with many more points than any output device can show (say, a Sound of an hour)
+	is recorded as its min/max envelope: two values per column, with twice as many columns
+	as device pixels at the highest resolution that a Picture is exported or printed at (600 dpi).
+	Replaying these values as a function draws the same vertical line per device pixel.
+*/
+#define FUNCTION_RECORDING_RESOLUTION  1200
+
+static autoVEC Graphics_function_envelope (Graphics me, const double yWC [], integer ix1, integer ix2, double x1WC, double x2WC) {
+	const integer n = ix2 - ix1 + 1;
+	const double widthInInches = fabs (x2WC - x1WC) * my scaleX / my resolution;
+	const integer numberOfColumns = Melder_iceiling (widthInInches * FUNCTION_RECORDING_RESOLUTION);
+	if (numberOfColumns < 1 || n <= 4 * numberOfColumns)
+		return autoVEC ();   // not worth it: record all the points
+	autoVEC envelope = newVECraw (2 * numberOfColumns);
+	for (integer icol = 0; icol < numberOfColumns; icol ++) {
+		const integer jmin = ix1 + icol * n / numberOfColumns;
+		const integer jmax = std::min (ix1 + (icol + 1) * n / numberOfColumns, ix2);   // one point overlap, as in drawing
+		integer jOfMinimum = jmin, jOfMaximum = jmin;
+		for (integer j = jmin + 1; j <= jmax; j ++) {
+			if (yWC [j] > yWC [jOfMaximum])
+				jOfMaximum = j;
+			else if (yWC [j] < yWC [jOfMinimum])
+				jOfMinimum = j;
+		}
+		const bool minimumComesFirst = ( jOfMinimum <= jOfMaximum );
+		envelope [2 * icol + 1] = yWC [minimumComesFirst ? jOfMinimum : jOfMaximum];
+		envelope [2 * icol + 2] = yWC [minimumComesFirst ? jOfMaximum : jOfMinimum];
+	}
+	return envelope;
+}
+
 void Graphics_function (Graphics me, const double yWC [], integer ix1, integer ix2, double x1WC, double x2WC) {
 	integer n = Graphics_function_ <double> (me, yWC, 1, ix1, ix2, x1WC, x2WC);
-	if (my recording && n >= 2) { op (FUNCTION, 3 + n); put (n); put (x1WC); put (x2WC); mput (n, & yWC [ix1]) }
+	if (my recording && n >= 2) {
+		autoVEC envelope = Graphics_function_envelope (me, yWC, ix1, ix2, x1WC, x2WC);
+		if (envelope.size > 0) {
+			op (FUNCTION, 3 + envelope.size); put (envelope.size); put (x1WC); put (x2WC); mput (envelope.size, & envelope [1])
+		} else {
+			op (FUNCTION, 3 + n); put (n); put (x1WC); put (x2WC); mput (n, & yWC [ix1])
+		}
+	}
 }
 
 void Graphics_function16 (Graphics me, const int16 yWC [], int stride, integer ix1, integer ix2, double x1WC, double x2WC) {
@@ -17,11 +17,14 @@
  */
 
 #include <ctype.h>
+#include <string>
+#include <unordered_map>
 #include "ManPages.h"
 #include "../kar/longchar.h"
 #include "Interpreter.h"
 #include "praat.h"
 
+Thing_implement (ManPagesIndex, Thing, 0);
 Thing_implement (ManPages, Daata, 0);
 
 #define LONGEST_FILE_NAME  55
@@ -394,6 +397,234 @@ static void grind (ManPages me) {
 	my ground = true;
 }
 
+/********** SEARCHING **********/
+
+static bool isIndexedCharacter (char32 kar) {
+	return Melder_isLetter (kar) || Melder_isDecimalNumber (kar);
+}
+
+static void copyToLowerCase (MelderString *buffer, conststring32 text) {
+	MelderString_copy (buffer, text);
+	for (char32 *p = & buffer -> string [0]; *p != U'\0'; p ++)
+		*p = Melder_toLowerCase (*p);
+}
+
+static autoManPagesIndex ManPagesIndex_create (ManPages pages) {
+	autoManPagesIndex me = Thing_new (ManPagesIndex);
+	my numberOfPages = pages -> pages.size;
+	my titles = autostring32vector (my numberOfPages);
+	std::unordered_map <std::u32string, integer> wordNumbers;
+	autoINTVEC postingWord, paragraphWords;
+	integer paragraphPageCapacity = 0, paragraphTextCapacity = 0, paragraphWordsCapacity = 0;
+	integer postingWordCapacity = 0, postingParagraphCapacity = 0, postingCountCapacity = 0;
+	autoMelderString buffer;
+	for (integer ipage = 1; ipage <= my numberOfPages; ipage ++) {
+		ManPage page = pages -> pages.at [ipage];
+		copyToLowerCase (& buffer, page -> title.get());
+		my titles [ipage] = Melder_dup (buffer.string);
+		for (ManPage_Paragraph par = & page -> paragraphs [0]; (int) par -> type != 0; par ++) {
+			if (! par -> text)
+				continue;
+			my numberOfParagraphs += 1;
+			my paragraphPage. resize (my numberOfParagraphs, & paragraphPageCapacity);
+			my paragraphPage [my numberOfParagraphs] = ipage;
+			my paragraphText. resize (my numberOfParagraphs, & paragraphTextCapacity);
+			my paragraphText [my numberOfParagraphs] = par -> text;
+			copyToLowerCase (& buffer, par -> text);
+			paragraphWords. resize (0);
+			for (const char32 *p = & buffer.string [0]; *p != U'\0'; ) {
+				if (! isIndexedCharacter (*p)) {
+					p ++;
+					continue;
+				}
+				const char32 *wordStart = p;
+				while (isIndexedCharacter (*p))
+					p ++;
+				const integer newWordNumber = (integer) wordNumbers.size () + 1;
+				const integer wordNumber = wordNumbers.emplace (std::u32string (wordStart, p), newWordNumber). first -> second;
+				paragraphWords. insert (paragraphWords.size + 1, wordNumber, & paragraphWordsCapacity);
+			}
+			/*
+				One posting for every distinct word in this paragraph, with the number of times it occurs.
+			*/
+			NUMsort_integer (paragraphWords.size, paragraphWords.at);
+			for (integer i = 1; i <= paragraphWords.size; i ++) {
+				if (i > 1 && paragraphWords [i] == paragraphWords [i - 1]) {
+					my postingCount [my postingCount.size] += 1;
+					continue;
+				}
+				const integer newSize = postingWord.size + 1;
+				postingWord. resize (newSize, & postingWordCapacity);
+				my postingParagraph. resize (newSize, & postingParagraphCapacity);
+				my postingCount. resize (newSize, & postingCountCapacity);
+				postingWord [newSize] = paragraphWords [i];
+				my postingParagraph [newSize] = my numberOfParagraphs;
+				my postingCount [newSize] = 1;
+			}
+		}
+	}
+	/*
+		Group the postings by word (stably, so that within a word they stay in paragraph order).
+	*/
+	const integer numberOfWords = (integer) wordNumbers.size (), numberOfPostings = postingWord.size;
+	my words = autostring32vector (numberOfWords);
+	for (const auto& word : wordNumbers)
+		my words [word.second] = Melder_dup (word.first.c_str ());
+	my firstPosting = newINTVECzero (numberOfWords + 1);
+	for (integer iposting = 1; iposting <= numberOfPostings; iposting ++)
+		my firstPosting [postingWord [iposting]] += 1;
+	integer start = 1;
+	for (integer iword = 1; iword <= numberOfWords + 1; iword ++) {
+		const integer numberOfPostingsOfThisWord = my firstPosting [iword];
+		my firstPosting [iword] = start;
+		start += numberOfPostingsOfThisWord;
+	}
+	autoINTVEC postingParagraph = newINTVECraw (numberOfPostings), postingCount = newINTVECraw (numberOfPostings);
+	autoINTVEC nextPosting = newINTVECcopy (my firstPosting.get());
+	for (integer iposting = 1; iposting <= numberOfPostings; iposting ++) {
+		const integer target = nextPosting [postingWord [iposting]] ++;
+		postingParagraph [target] = my postingParagraph [iposting];
+		postingCount [target] = my postingCount [iposting];
+	}
+	my postingParagraph = postingParagraph.move();
+	my postingCount = postingCount.move();
+	my paragraphOccurrences = newINTVECzero (my numberOfParagraphs);
+	my touchedParagraphs = newINTVECraw (my numberOfParagraphs);
+	return me;
+}
+
+static double scoreInParagraph_scan (conststring32 text, conststring32 token, MelderString *buffer) {
+	copyToLowerCase (buffer, text);
+	const char32 *occurrence = str32str (buffer -> string, token);
+	if (! occurrence)
+		return 0.0;
+	if (str32str (occurrence + str32len (token), token))
+		return 11.0;   // one point for every second occurrence in a paragraph!
+	return 10.0;   // ten points for every paragraph with a match!
+}
+
+static void getScoresOfToken (ManPages me, conststring32 token, VEC const& score) {
+	ManPagesIndex index = my index.get();
+	for (integer ipage = 1; ipage <= index -> numberOfPages; ipage ++) {
+		score [ipage] = 0.0;
+		conststring32 title = index -> titles [ipage].get();
+		if (str32str (title, token)) {
+			score [ipage] += 300.0;   // lots of points for a match in the title!
+			if (str32equ (title, token))
+				score [ipage] += 10000.0;   // even more points for an exact match!
+		}
+	}
+	/*
+		Every paragraph that contains the token contains a word that contains
+		the longest run of letters and digits in the token.
+	*/
+	const integer tokenLength = str32len (token);
+	integer runStart = 0, runLength = 0;
+	for (integer i = 0; i < tokenLength; ) {
+		if (! isIndexedCharacter (token [i])) {
+			i ++;
+			continue;
+		}
+		const integer start = i;
+		while (i < tokenLength && isIndexedCharacter (token [i]))
+			i ++;
+		if (i - start > runLength) {
+			runStart = start;
+			runLength = i - start;
+		}
+	}
+	autoMelderString buffer;
+	if (runLength == 0) {
+		for (integer iparagraph = 1; iparagraph <= index -> numberOfParagraphs; iparagraph ++)
+			score [index -> paragraphPage [iparagraph]] += scoreInParagraph_scan (index -> paragraphText [iparagraph], token, & buffer);
+		return;
+	}
+	MelderString_ncopy (& buffer, & token [runStart], runLength);
+	autostring32 run = Melder_dup (buffer.string);
+	/*
+		If the token consists of letters and digits only, it cannot straddle word boundaries,
+		so counting its non-overlapping occurrences inside each word
+		tells us whether it occurs in a paragraph a second time.
+		Otherwise, we look for it in the text of the candidate paragraphs.
+	*/
+	const bool tokenIsInsideWords = ( runLength == tokenLength );
+	integer numberOfTouchedParagraphs = 0;
+	for (integer iword = 1; iword <= index -> words.size; iword ++) {
+		const char32 *occurrence = str32str (index -> words [iword].get(), run.get());
+		if (! occurrence)
+			continue;
+		integer numberOfOccurrencesInWord = 0;
+		do {
+			numberOfOccurrencesInWord += 1;
+			occurrence = str32str (occurrence + runLength, run.get());
+		} while (occurrence);
+		for (integer iposting = index -> firstPosting [iword]; iposting < index -> firstPosting [iword + 1]; iposting ++) {
+			const integer iparagraph = index -> postingParagraph [iposting];
+			if (index -> paragraphOccurrences [iparagraph] == 0)
+				index -> touchedParagraphs [++ numberOfTouchedParagraphs] = iparagraph;
+			index -> paragraphOccurrences [iparagraph] += numberOfOccurrencesInWord * index -> postingCount [iposting];
+		}
+	}
+	for (integer itouched = 1; itouched <= numberOfTouchedParagraphs; itouched ++) {
+		const integer iparagraph = index -> touchedParagraphs [itouched];
+		if (tokenIsInsideWords)
+			score [index -> paragraphPage [iparagraph]] += ( index -> paragraphOccurrences [iparagraph] > 1 ? 11.0 : 10.0 );
+		else
+			score [index -> paragraphPage [iparagraph]] += scoreInParagraph_scan (index -> paragraphText [iparagraph], token, & buffer);
+		index -> paragraphOccurrences [iparagraph] = 0;
+	}
+}
+
+autoINTVEC ManPages_search (ManPages me, conststring32 query, integer maximumNumberOfMatches) {
+	if (! my ground)
+		grind (me);
+	if (! my index || my index -> numberOfPages != my pages.size)
+		my index = ManPagesIndex_create (me);
+	const integer numberOfPages = my pages.size;
+	autoMelderString searchText;
+	copyToLowerCase (& searchText, query);
+	for (char32 *p = & searchText.string [0]; *p != U'\0'; p ++)
+		if (*p == U'\n')
+			*p = U' ';
+	autoVEC goodnessOfMatch = newVECraw (numberOfPages), score = newVECraw (numberOfPages);
+	for (integer ipage = 1; ipage <= numberOfPages; ipage ++)
+		goodnessOfMatch [ipage] = 1.0;
+	for (char32 *token = searchText.string;; ) {
+		char32 *space = str32chr (token, U' ');
+		if (space)
+			*space = U'\0';
+		if (token [0] != U'\0') {   // an empty token matches everything
+			getScoresOfToken (me, token, score.get());
+			for (integer ipage = 1; ipage <= numberOfPages; ipage ++)
+				goodnessOfMatch [ipage] *= score [ipage];
+		}
+		if (! space)
+			break;
+		token = space + 1;
+	}
+	/*
+		Find the best matches; of equally good pages, the first comes first.
+	*/
+	autoINTVEC matches = newINTVECraw (maximumNumberOfMatches);
+	integer numberOfMatches = 0;
+	while (numberOfMatches < maximumNumberOfMatches) {
+		integer imax = 0;
+		double max = 0.0;
+		for (integer ipage = 1; ipage <= numberOfPages; ipage ++) {
+			if (goodnessOfMatch [ipage] > max) {
+				max = goodnessOfMatch [ipage];
+				imax = ipage;
+			}
+		}
+		if (! imax)
+			break;
+		matches [++ numberOfMatches] = imax;
+		goodnessOfMatch [imax] = 0.0;   // skip next time
+	}
+	matches. resize (numberOfMatches);
+	return matches;
+}
+
 integer ManPages_uniqueLinksHither (ManPages me, integer ipage) {
 	ManPage page = my pages.at [ipage];
 	integer result = page -> nlinksHither;
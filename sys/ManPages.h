@@ -21,11 +21,27 @@
 #include "ManPage.h"
 #include "Collection.h"
 
+/*
+	An inverted index of the lower-case words in the titles and paragraphs, built by the first search.
+	A word is a maximal run of letters and digits; paragraphs are numbered consecutively through all pages.
+*/
+Thing_define (ManPagesIndex, Thing) {
+	integer numberOfPages, numberOfParagraphs;
+	autostring32vector titles;   // in lower case
+	autoINTVEC paragraphPage;   // [iparagraph]
+	autovector <conststring32> paragraphText;   // [iparagraph]; not owned
+	autostring32vector words;   // [iword]
+	autoINTVEC firstPosting;   // [iword]; the postings of iword run up to firstPosting [iword + 1] - 1
+	autoINTVEC postingParagraph, postingCount;   // [iposting]
+	autoINTVEC paragraphOccurrences, touchedParagraphs;   // [iparagraph]; scratch space for a search
+};
+
 Thing_define (ManPages, Daata) {
 	OrderedOf<structManPage> pages;
 	autostring32vector titles;
 	bool ground, dynamic, executable;
 	structMelderDir rootDirectory;
+	autoManPagesIndex index;
 
 	void v_destroy () noexcept
 		override;
@@ -47,6 +63,15 @@ integer ManPages_lookUp (ManPages me, conststring32 title);
 void ManPages_writeOneToHtmlFile (ManPages me, integer ipage, MelderFile file);
 void ManPages_writeAllToHtmlDir (ManPages me, conststring32 dirPath);
 
+autoINTVEC ManPages_search (ManPages me, conststring32 query, integer maximumNumberOfMatches);
+/*
+	Returns the numbers of the pages that best match the space-separated strings in `query`,
+	best match first. Every string scores on a page if it occurs case-insensitively in the title
+	(300 points, plus 10000 if it is the whole title) or in paragraphs (10 points for every paragraph,
+	plus 1 point if it occurs in that paragraph a second time); the goodness of a page is the product
+	of the scores of all strings.
+*/
+
 integer ManPages_uniqueLinksHither (ManPages me, integer ipage);
 conststring32vector ManPages_getTitles (ManPages me);
 
@@ -22,7 +22,11 @@
 #if defined (UNIX) || defined (macintosh)
 	#include <sys/types.h>
 	#include <sys/stat.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <sys/wait.h>
 	#include <signal.h>
+	#include <errno.h>
 #endif
 #include <locale.h>
 #if defined (UNIX)
@@ -110,8 +114,61 @@ static structMelderFile buttonsFile { };
  */
 static structMelderFile tracingFile { };
 
+/*
+ * profileFile: the trace-event file written by "praat --profile=FILE".
+ */
+static structMelderFile profileFile { };
+
 static GuiList praatList_objects;
 
+/***** PROFILING *****/
+
+bool praat_profiling;
+static double theProfileStartTime;   // set at the start of praat_init, so that all time stamps are relative to it
+static autoMelderString theProfileEvents;
+
+static void appendJsonString (MelderString *buffer, conststring32 string) {
+	MelderString_appendCharacter (buffer, U'\"');
+	for (const char32 *p = & string [0]; *p != U'\0'; p ++) {
+		if (*p == U'\"' || *p == U'\\')
+			MelderString_append (buffer, U"\\", *p);
+		else if (*p < 32)
+			MelderString_append (buffer, U"\\u00", Melder_hexadecimal (*p, 2));
+		else
+			MelderString_appendCharacter (buffer, *p);
+	}
+	MelderString_appendCharacter (buffer, U'\"');
+}
+
+void praat_recordProfileEvent (conststring32 category, conststring32 name, double startTime) {
+	const double endTime = Melder_clock ();
+	try {
+		MelderString_append (& theProfileEvents, theProfileEvents.length == 0 ? U"\n" : U",\n", U"{\"name\":");
+		appendJsonString (& theProfileEvents, name);
+		MelderString_append (& theProfileEvents, U",\"cat\":");
+		appendJsonString (& theProfileEvents, category);
+		MelderString_append (& theProfileEvents,
+			U",\"ph\":\"X\",\"ts\":", Melder_iround (1e6 * (startTime - theProfileStartTime)),   // in microseconds
+			U",\"dur\":", Melder_iround (1e6 * (endTime - startTime)),
+			U",\"pid\":1,\"tid\":1}"
+		);
+	} catch (MelderError) {
+		Melder_clearError ();   // profiling should never make Praat fail
+	}
+}
+
+static void praat_writeProfile () {
+	if (! praat_profiling)
+		return;
+	try {
+		autoMelderString buffer;
+		MelderString_append (& buffer, U"{\"traceEvents\":[", theProfileEvents.string, U"\n],\"displayTimeUnit\":\"ms\"}\n");
+		MelderFile_writeText (& profileFile, buffer.string, kMelder_textOutputEncoding::UTF8);
+	} catch (MelderError) {
+		Melder_flushError (praatP.title.get(), U": profile not written.");
+	}
+}
+
 /***** selection *****/
 
 integer praat_idOfSelected (ClassInfo klas, integer inplace) {
@@ -500,7 +557,7 @@ static void praat_exit (int exit_code) {
 			/*
 			 * We are going to delete the process id ("pid") file, if it's ours.
 			 */
-			if (pidFile. path [0]) {
+			if (pidFile. path [0] && MelderFile_exists (& pidFile)) {   // a batch session has not written it
 				try {
 					/*
 					 * To see whether we own the pid file,
@@ -552,6 +609,8 @@ static void praat_exit (int exit_code) {
 	}
 	Melder_files_cleanUp ();   // in case a URL is open
 
+	praat_writeProfile ();
+
 	trace (U"leave the program");
 	praat_menuCommands_exit_optimizeByLeaking ();   // these calls are superflous if subsequently _Exit() is called instead of exit()
 	praat_actions_exit_optimizeByLeaking ();
@@ -798,13 +857,34 @@ void praat_dataChanged (Daata object) {
 	}
 }
 
+/***** MANUAL PAGES *****/
+
+static void (*theManPagesInitProcs [1 + 100]) (ManPages me);
+static integer theNumberOfManPagesInitProcs, theNumberOfManPagesInitProcsCalled;
+
+void praat_addManPages (void (*manual_xxx_init) (ManPages me)) {
+	Melder_assert (theNumberOfManPagesInitProcs < 100);
+	theManPagesInitProcs [++ theNumberOfManPagesInitProcs] = manual_xxx_init;
+}
+
+ManPages praat_getManPages () {
+	if (! theCurrentPraatApplication -> manPages || theNumberOfManPagesInitProcsCalled < theNumberOfManPagesInitProcs) {
+		autoPraatProfileEvent event (U"init", U"manual pages");
+		if (! theCurrentPraatApplication -> manPages)
+			theCurrentPraatApplication -> manPages = ManPages_create ().releaseToAmbiguousOwner();
+		while (theNumberOfManPagesInitProcsCalled < theNumberOfManPagesInitProcs)
+			theManPagesInitProcs [++ theNumberOfManPagesInitProcsCalled] (theCurrentPraatApplication -> manPages);
+	}
+	return theCurrentPraatApplication -> manPages;
+}
+
 static void helpProc (conststring32 query) {
 	if (theCurrentPraatApplication -> batch) {
 		Melder_flushError (U"Cannot view manual from batch.");
 		return;
 	}
 	try {
-		autoManual manual = Manual_create (query, theCurrentPraatApplication -> manPages, false);
+		autoManual manual = Manual_create (query, praat_getManPages (), false);
 		manual.releaseToUser();
 	} catch (MelderError) {
 		Melder_flushError (U"help: no help on \"", query, U"\".");
@@ -1076,6 +1156,7 @@ static void injectMessageAndInformationProcs (GuiWindow parent) {
 
 void praat_init (conststring32 title, int argc, char **argv)
 {
+	theProfileStartTime = Melder_clock ();
 	bool weWereStartedFromTheCommandLine = tryToAttachToTheCommandLine ();
 
 	for (int iarg = 0; iarg < argc; iarg ++) {
@@ -1118,6 +1199,13 @@ void praat_init (conststring32 title, int argc, char **argv)
 		} else if (strnequ (argv [praatP.argumentNumber], "--pref-dir=", 11)) {
 			Melder_pathToDir (Melder_peek8to32 (argv [praatP.argumentNumber] + 11), & praatDir);
 			praatP.argumentNumber += 1;
+		} else if (strnequ (argv [praatP.argumentNumber], "--profile=", 10)) {
+			Melder_relativePathToFile (Melder_peek8to32 (argv [praatP.argumentNumber] + 10), & profileFile);
+			praat_profiling = true;
+			praatP.argumentNumber += 1;
+		} else if (strnequ (argv [praatP.argumentNumber], "--server=", 9)) {
+			praatP.serverSocketPath = argv [praatP.argumentNumber] + 9;
+			praatP.argumentNumber += 1;
 		} else if (strequ (argv [praatP.argumentNumber], "--version")) {
 			#define xstr(s) str(s)
 			#define str(s) #s
@@ -1133,6 +1221,8 @@ void praat_init (conststring32 title, int argc, char **argv)
 			MelderInfo_writeLine (U"  --no-pref-files  don't read or write the preferences file and the buttons file");
 			MelderInfo_writeLine (U"  --no-plugins     don't activate the plugins");
 			MelderInfo_writeLine (U"  --pref-dir=DIR   set the preferences directory to DIR");
+			MelderInfo_writeLine (U"  --profile=FILE   write the durations of start-up steps and script commands to FILE (trace-event JSON)");
+			MelderInfo_writeLine (U"  --server=SOCKET  stay resident and run the scripts that are sent to the Unix-domain socket SOCKET");
 			MelderInfo_writeLine (U"  --version        print the Praat version");
 			MelderInfo_writeLine (U"  --help           print this list of command line options");
 			MelderInfo_writeLine (U"  -u, --utf16      use UTF-16LE output encoding, no BOM (the default on Windows)");
@@ -1193,6 +1283,16 @@ void praat_init (conststring32 title, int argc, char **argv)
 	 */
 	Melder_batch |= praatP.hasCommandLineInput;
 
+	/*
+	 * Running Praat as a script server:
+	 *    praat --server=/tmp/praat.socket
+	 */
+	if (praatP.serverSocketPath) {
+		if (thereIsAFileNameInTheArgumentList && ! foundTheOpenOption)
+			Melder_throw (U"Cannot have both a server socket and a script file.");
+		Melder_batch = true;
+	}
+
 	praatP.title = Melder_dup (title && title [0] != U'\0' ? title : U"Praat");
 
 	theCurrentPraatApplication -> batch = Melder_batch;
@@ -1314,10 +1414,13 @@ void praat_init (conststring32 title, int argc, char **argv)
 	/*
 	 * Make room for commands.
 	 */
-	trace (U"initing actions");
-	praat_actions_init ();
-	trace (U"initing menu commands");
-	praat_menuCommands_init ();
+	{
+		autoPraatProfileEvent event (U"init", U"praat_actions_init, praat_menuCommands_init");
+		trace (U"initing actions");
+		praat_actions_init ();
+		trace (U"initing menu commands");
+		praat_menuCommands_init ();
+	}
 
 	GuiWindow raam = nullptr;
 	if (Melder_batch) {
@@ -1369,6 +1472,7 @@ void praat_init (conststring32 title, int argc, char **argv)
 	Thing_recognizeClassesByName (classCollection, classStrings, classManPages, classStringSet, nullptr);
 	Thing_recognizeClassByOtherName (classStringSet, U"SortedSetOfString");
 	if (Melder_batch) {
+		autoPraatProfileEvent event (U"init", U"praat_addMenus, praat_addFixedButtons");
 		Melder_backgrounding = true;
 		trace (U"adding menus without GUI");
 		praat_addMenus (nullptr);
@@ -1423,13 +1527,18 @@ void praat_init (conststring32 title, int argc, char **argv)
 		Melder_setHelpProc (helpProc);
 	}
 	Data_setPublishProc (publishProc);
-	theCurrentPraatApplication -> manPages = ManPages_create ().releaseToAmbiguousOwner();
 
 	trace (U"creating the Picture window");
 	trace (U"before picture window shows: locale is ", Melder_peek8to32 (setlocale (LC_ALL, nullptr)));
-	if (! praatP.dontUsePictureWindow) praat_picture_init ();
+	if (! praatP.dontUsePictureWindow) {
+		autoPraatProfileEvent event (U"init", U"praat_picture_init");
+		praat_picture_init ();
+	}
 	trace (U"after picture window shows: locale is ", Melder_peek8to32 (setlocale (LC_ALL, nullptr)));
 
+	if (praat_profiling)
+		praat_recordProfileEvent (U"init", U"praat_init", theProfileStartTime);
+
 	if (unknownCommandLineOption) {
 		Melder_fatal (U"Unrecognized command line option ", unknownCommandLineOption.get());
 	}
@@ -1441,8 +1550,8 @@ static void executeStartUpFile (MelderDir startUpDirectory, conststring32 fileNa
 	if (! MelderDir_isNull (startUpDirectory)) {   // should not occur on modern systems
 		structMelderFile startUp { };
 		MelderDir_getFile (startUpDirectory, name, & startUp);
-		if (! MelderFile_readable (& startUp))
-			return;   // it's OK if the file doesn't exist
+		if (! MelderFile_exists (& startUp) || ! MelderFile_readable (& startUp))
+			return;   // it's OK if the file doesn't exist (checked first without throwing, because the first exception in a process is slow)
 		try {
 			praat_executeScriptFromFile (& startUp, nullptr);
 		} catch (MelderError) {
@@ -1494,9 +1603,122 @@ static void executeStartUpFile (MelderDir startUpDirectory, conststring32 fileNa
 	#endif
 #endif
 
+#if defined (UNIX) || defined (macintosh)
+/*
+	Server mode ("praat --server=SOCKET"): the expensive initialization (actions, menus, manual pages, plugins)
+	is done only once, after which every connection to the Unix-domain socket SOCKET is served by a fork
+	of the initialized process, so that every job starts with an empty object list, a fresh Interpreter,
+	and no traces of earlier jobs.
+
+	Protocol: the client sends a single line, terminated by a newline or a null byte,
+	that contains the path of a script file followed by its arguments, as after "praat --run";
+	a relative path is relative to the directory in which the server was started.
+	The server sends back everything the script writes to standard output and standard error,
+	followed by a null byte and the exit status as a decimal number and a newline
+	(0 if the script succeeded, 1 if it failed, 128 plus the signal number if it crashed).
+*/
+static void server_runJob (int connection) {
+	char request8 [10000];
+	integer length = 0;
+	while (length < (integer) sizeof (request8) - 1) {
+		const ssize_t numberOfBytesRead = read (connection, & request8 [length], sizeof (request8) - 1 - length);
+		if (numberOfBytesRead <= 0)
+			break;
+		const char *endOfLine = (const char *) memchr (& request8 [length], '\n', numberOfBytesRead);
+		const char *nullByte = (const char *) memchr (& request8 [length], '\0', numberOfBytesRead);
+		length += numberOfBytesRead;
+		if (endOfLine || nullByte)
+			break;
+	}
+	request8 [length] = '\0';
+	request8 [strcspn (request8, "\r\n")] = '\0';
+	dup2 (connection, STDOUT_FILENO);
+	dup2 (connection, STDERR_FILENO);
+	close (connection);
+	int exitStatus = 0;
+	try {
+		autostring32 request = Melder_8to32 (request8);
+		if (request [0] == U'\0')
+			Melder_throw (U"Empty request.");
+		praat_executeScriptFromFileNameWithArguments (request.get());
+	} catch (MelderError) {
+		Melder_flushError (praatP.title.get(), U": script command <<", Melder_peek8to32 (request8), U">> not completed.");
+		exitStatus = 1;
+	}
+	fflush (stdout);
+	fflush (stderr);
+	_exit (exitStatus);   // don't write preferences or run exit-time destructors
+}
+
+static void server_superviseJob (int connection) {
+	int exitStatus = 128;
+	fflush (stdout);   // otherwise, anything still buffered would be written by both processes
+	fflush (stderr);
+	const pid_t job = fork ();
+	if (job == 0)
+		server_runJob (connection);   // does not return
+	if (job > 0) {
+		int status;
+		while (waitpid (job, & status, 0) < 0 && errno == EINTR) { }
+		exitStatus = ( WIFEXITED (status) ? WEXITSTATUS (status) : WIFSIGNALED (status) ? 128 + WTERMSIG (status) : 128 );
+	}
+	char trailer [20];
+	const int trailerLength = snprintf (trailer, sizeof (trailer), "%c%d\n", '\0', exitStatus);
+	(void) ! write (connection, trailer, trailerLength);
+	close (connection);
+}
+
+static void server_run (const char *socketPath) {
+	struct sockaddr_un address { };
+	address. sun_family = AF_UNIX;
+	Melder_require (strlen (socketPath) < sizeof (address. sun_path),
+		U"The server socket path ", Melder_peek8to32 (socketPath), U" is too long.");
+	strcpy (address. sun_path, socketPath);
+	/*
+		A stale socket from an earlier server would make bind() fail, so we remove it;
+		but we never remove anything else that the user may have named by accident.
+	*/
+	struct stat status;
+	if (lstat (socketPath, & status) == 0) {
+		if (! S_ISSOCK (status. st_mode))
+			Melder_throw (U"Cannot use ", Melder_peek8to32 (socketPath), U" as the server socket, because it exists and is not a socket.");
+		unlink (socketPath);
+	}
+	const int listener = socket (AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0)
+		Melder_throw (U"Cannot create the server socket.");
+	if (bind (listener, (struct sockaddr *) & address, sizeof (address)) != 0 || listen (listener, SOMAXCONN) != 0)
+		Melder_throw (U"Cannot listen on the server socket ", Melder_peek8to32 (socketPath), U".");
+	praat_writeProfile ();   // only the start-up is profiled, because the jobs never return to this process
+	signal (SIGCHLD, SIG_IGN);   // the supervisors are reaped automatically
+	signal (SIGPIPE, SIG_IGN);   // a client that goes away should not kill us
+	for (;;) {
+		const int connection = accept (listener, nullptr, nullptr);
+		if (connection < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			Melder_throw (U"Cannot accept a connection on the server socket ", Melder_peek8to32 (socketPath), U".");
+		}
+		fflush (stdout);   // otherwise, anything still buffered would be written by both processes
+		fflush (stderr);
+		const pid_t supervisor = fork ();
+		if (supervisor == 0) {
+			close (listener);
+			signal (SIGCHLD, SIG_DFL);   // so that the supervisor can wait for its job
+			server_superviseJob (connection);
+			_exit (0);
+		}
+		close (connection);   // the supervisor has its own copy (or the fork failed, which the client will notice)
+	}
+}
+#endif
+
 void praat_run () {
 	trace (U"adding menus, second round");
-	praat_addMenus2 ();
+	{
+		autoPraatProfileEvent event (U"init", U"praat_addMenus2");
+		praat_addMenus2 ();
+	}
 	trace (U"locale is ", Melder_peek8to32 (setlocale (LC_ALL, nullptr)));
 
 	trace (U"adding the Quit command");
@@ -1509,6 +1731,7 @@ void praat_run () {
 	 * (namely, the session counter and the cross-session memory counter).
 	 */
 	if (! praatP.ignorePreferenceFiles) {
+		autoPraatProfileEvent event (U"init", U"preferences");
 		Preferences_read (& prefsFile);
 		if (! praatP.dontUsePictureWindow) praat_picture_prefsChanged ();
 		praat_statistics_prefsChanged ();
@@ -1520,17 +1743,20 @@ void praat_run () {
 	/*
 	 * On Unix and the Mac, we try no less than three start-up file names.
 	 */
-	#if defined (UNIX) || defined (macintosh)
-		structMelderDir usrLocal { };
-		Melder_pathToDir (U"/usr/local", & usrLocal);
-		executeStartUpFile (& usrLocal, U"", U"-startUp");
-	#endif
-	#if defined (UNIX) || defined (macintosh)
-		executeStartUpFile (& homeDir, U".", U"-user-startUp");   // not on Windows (empty file name error)
-	#endif
-	#if defined (UNIX) || defined (macintosh) || defined (_WIN32)
-		executeStartUpFile (& homeDir, U"", U"-user-startUp");
-	#endif
+	{
+		autoPraatProfileEvent event (U"init", U"start-up files");
+		#if defined (UNIX) || defined (macintosh)
+			structMelderDir usrLocal { };
+			Melder_pathToDir (U"/usr/local", & usrLocal);
+			executeStartUpFile (& usrLocal, U"", U"-startUp");
+		#endif
+		#if defined (UNIX) || defined (macintosh)
+			executeStartUpFile (& homeDir, U".", U"-user-startUp");   // not on Windows (empty file name error)
+		#endif
+		#if defined (UNIX) || defined (macintosh) || defined (_WIN32)
+			executeStartUpFile (& homeDir, U"", U"-user-startUp");
+		#endif
+	}
 
 	if (! MelderDir_isNull (& praatDir) && ! praatP.ignorePlugins) {
 		trace (U"install plug-ins");
@@ -1549,6 +1775,7 @@ void praat_run () {
 					MelderDir_getSubdir (& praatDir, directoryNames -> strings [i].get(), & pluginDir);
 					MelderDir_getFile (& pluginDir, U"setup.praat", & plugin);
 					if (MelderFile_readable (& plugin)) {
+						autoPraatProfileEvent event (U"plugin", directoryNames -> strings [i].get());
 						Melder_backgrounding = true;
 						try {
 							praat_executeScriptFromFile (& plugin, nullptr);
@@ -1774,7 +2001,18 @@ void praat_run () {
 		"sizeof(off_t) is less than 8. Compile Praat with -D_FILE_OFFSET_BITS=64.");
 
 	if (Melder_batch) {
-		if (thePraatStandAloneScriptText) {
+		if (praatP.serverSocketPath) {
+			try {
+				#if defined (UNIX) || defined (macintosh)
+					server_run (praatP.serverSocketPath);
+				#else
+					Melder_throw (U"The --server option is available only on Unix and MacOS.");
+				#endif
+			} catch (MelderError) {
+				Melder_flushError (praatP.title.get(), U": server stopped.");
+				praat_exit (-1);
+			}
+		} else if (thePraatStandAloneScriptText) {
 			try {
 				praat_executeScriptFromText (thePraatStandAloneScriptText);
 				praat_exit (0);
@@ -1793,7 +2031,10 @@ void praat_run () {
 		} else {
 			try {
 				//Melder_casual (U"Script <<", theCurrentPraatApplication -> batchName.string, U">>");
-				praat_executeScriptFromFileNameWithArguments (theCurrentPraatApplication -> batchName.string);
+				{
+					autoPraatProfileEvent event (U"script", theCurrentPraatApplication -> batchName.string);
+					praat_executeScriptFromFileNameWithArguments (theCurrentPraatApplication -> batchName.string);
+				}
 				praat_exit (0);
 			} catch (MelderError) {
 				Melder_flushError (praatP.title.get(), U": script command <<",
@@ -818,12 +818,41 @@ void praat_picture_close ();
 /* These two routines should bracket drawing commands. */
 /* However, they usually do so RAII-wise by being packed into autoPraatPicture (see GRAPHICS_EACH). */
 
+/*
+	Profiling ("praat --profile=FILE"): the steps of starting up, the plug-ins, the script,
+	and every command that the script runs together with its callback, are recorded as "complete" events
+	in the Trace Event Format (as read by Perfetto or chrome://tracing), which is written to FILE when Praat exits.
+*/
+extern bool praat_profiling;
+void praat_recordProfileEvent (conststring32 category, conststring32 name, double startTime);   // startTime from Melder_clock ()
+struct autoPraatProfileEvent {
+	conststring32 category, name;
+	bool isRecording;
+	double startTime = 0.0;
+	autoPraatProfileEvent (conststring32 initialCategory, conststring32 initialName) :
+		category (initialCategory), name (initialName), isRecording (praat_profiling)
+	{
+		if (isRecording)
+			startTime = Melder_clock ();
+	}
+	~autoPraatProfileEvent () {
+		if (isRecording)
+			praat_recordProfileEvent (category, name, startTime);
+	}
+};
+
 /* For main.cpp */
 
 #define INCLUDE_LIBRARY(praat_xxx_init)  \
-   { extern void praat_xxx_init (); praat_xxx_init (); }
+   { extern void praat_xxx_init (); autoPraatProfileEvent event (U"init", U"" #praat_xxx_init); praat_xxx_init (); }
 #define INCLUDE_MANPAGES(manual_xxx_init)  \
-   { extern void manual_xxx_init (ManPages me); manual_xxx_init (theCurrentPraatApplication -> manPages); }
+   { extern void manual_xxx_init (ManPages me); praat_addManPages (manual_xxx_init); }
+void praat_addManPages (void (*manual_xxx_init) (ManPages me));
+/*
+	Registers the pages without creating them; that happens in praat_getManPages,
+	so that a batch run, which usually never shows a manual, does not have to build thousands of pages.
+*/
+ManPages praat_getManPages ();
 
 /* For text-only applications that do not want to see that irritating Picture window. */
 /* Works only if called before praat_init. */
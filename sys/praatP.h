@@ -189,6 +189,7 @@ extern struct PraatP {
 	bool dontUsePictureWindow;   // see praat_dontUsePictureWindow ()
 	bool ignorePreferenceFiles, ignorePlugins;
 	bool hasCommandLineInput;
+	const char *serverSocketPath;   // see the --server option
 	autostring32 title;
 	GuiWindow menuBar;
 	int phase;
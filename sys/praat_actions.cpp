@@ -705,6 +705,7 @@ int praat_doAction (conststring32 command, conststring32 arguments, Interpreter
 	integer i = 1;
 	while (i <= theActions.size && (! theActions.at [i] -> executable || str32cmp (theActions.at [i] -> title.get(), command))) i ++;
 	if (i > theActions.size) return 0;   // not found
+	autoPraatProfileEvent event (U"callback", command);
 	theActions.at [i] -> callback (nullptr, 0, nullptr, arguments, interpreter, command, false, nullptr);
 	return 1;
 }
@@ -713,6 +714,7 @@ int praat_doAction (conststring32 command, integer narg, Stackel args, Interpret
 	integer i = 1;
 	while (i <= theActions.size && (! theActions.at [i] -> executable || str32cmp (theActions.at [i] -> title.get(), command))) i ++;
 	if (i > theActions.size) return 0;   // not found
+	autoPraatProfileEvent event (U"callback", command);
 	theActions.at [i] -> callback (nullptr, narg, args, nullptr, interpreter, command, false, nullptr);
 	return 1;
 }
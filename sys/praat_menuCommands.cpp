@@ -429,6 +429,7 @@ int praat_doMenuCommand (conststring32 title, conststring32 arguments, Interpret
 		}
 	}
 	if (! commandFound) return 0;
+	autoPraatProfileEvent event (U"callback", title);
 	commandFound -> callback (nullptr, 0, nullptr, arguments, interpreter, title, false, nullptr);
 	return 1;
 }
@@ -445,6 +446,7 @@ int praat_doMenuCommand (conststring32 title, integer narg, Stackel args, Interp
 		}
 	}
 	if (! commandFound) return 0;
+	autoPraatProfileEvent event (U"callback", title);
 	commandFound -> callback (nullptr, narg, args, nullptr, interpreter, title, false, nullptr);
 	return 1;
 }
@@ -512,20 +512,20 @@ FORM (HELP_SearchManual, U"Search manual", U"Manual") {
 DO
 	if (theCurrentPraatApplication -> batch)
 		Melder_throw (U"Cannot view a manual from batch.");
-	autoManual manual = Manual_create (U"Intro", theCurrentPraatApplication -> manPages, false);
+	autoManual manual = Manual_create (U"Intro", praat_getManPages (), false);
 	Manual_search (manual.get(), query);
 	manual.releaseToUser();
 END }
 
 FORM (HELP_GoToManualPage, U"Go to manual page", nullptr) {
 	static conststring32vector pages;
-	pages = ManPages_getTitles (theCurrentPraatApplication -> manPages);
+	pages = ManPages_getTitles (praat_getManPages ());
 	LIST (pageNumber, U"Page", pages, 1)
 	OK
 DO
 	if (theCurrentPraatApplication -> batch)
 		Melder_throw (U"Cannot view a manual from batch.");
-	autoManual manual = Manual_create (U"Intro", theCurrentPraatApplication -> manPages, false);
+	autoManual manual = Manual_create (U"Intro", praat_getManPages (), false);
 	HyperPage_goToPage_i (manual.get(), pageNumber);
 	manual.releaseToUser();
 END }
@@ -537,7 +537,7 @@ OK
 	Melder_getDefaultDir (& currentDirectory);
 	SET_STRING (directory, Melder_dirToPath (& currentDirectory))
 DO
-	ManPages_writeAllToHtmlDir (theCurrentPraatApplication -> manPages, directory);
+	ManPages_writeAllToHtmlDir (praat_getManPages (), directory);
 END }
 
 /********** Menu descriptions. **********/
@@ -435,6 +435,8 @@ int praat_executeCommand (Interpreter interpreter, char32 *command) {
 			}
 		}
 
+		autoPraatProfileEvent event (U"command", command);   // `command` now ends before the arguments
+
 		/* See if command exists and is available; ignore separators. */
 		/* First try loose commands, then fixed commands. */
 